@@ -0,0 +1,124 @@
+#include "N_health.h"
+
+// ------------------------------------------------------------------------
+// HC-SR04 sensor health monitor
+// ------------------------------------------------------------------------
+// Every finished ping is reported with its result, the ISR edges that
+// do not belong to an echo, and the level of the echo line. The last
+// HEALTH_WINDOW results are kept as bit masks, so the rolling rates are
+// a popcount.
+//
+//   stuck : timeouts without any edge while the echo line stays high
+//           (high at the trigger and at the timeout)
+//   dead  : timeouts without any edge while the echo line stays low
+//
+// A genuine HC-SR04 without a target still answers with a ~38 ms pulse
+// (out of range), so a silent line means a wiring or power fault.
+// Out-of-range echoes are counted, but do not degrade : an empty
+// field of view is not a fault.
+// Stuck and dead sensors are recovered by re-initialising the pins
+// first, then by power-cycling the Grove 5V where it can be switched,
+// retried with a growing interval until a valid echo comes back.
+// ------------------------------------------------------------------------
+namespace Health
+{
+  constexpr uint8_t STUCK_PINGS = 4;     // consecutive stuck pings
+  constexpr uint8_t DEAD_PINGS = 8;      // consecutive silent pings
+  constexpr uint8_t DEGRADED_FAULTS = 8; // faulty pings in the window
+  constexpr uint64_t RETRY_MIN_MS = 5 * 1000ULL;
+  constexpr uint64_t RETRY_MAX_MS = 60 * 1000ULL;
+}
+
+const char *SENSOR_HEALTH_NAME[] = {"ok", "degraded", "stuck", "dead"};
+static HealthStats stats = {};
+static uint32_t maskTimeout = 0; // bit 0 : latest ping
+static uint32_t maskRange = 0;
+static uint32_t maskSpurious = 0;
+static uint8_t consecStuck = 0;
+static uint8_t consecDead = 0;
+static SensorHealth health = SH_OK;
+static uint8_t recoverAttempts = 0; // since the last valid echo
+static uint64_t prevRecoverMs = 0;
+static bool powerCycleOk = false;
+
+static uint8_t bitCount(uint32_t mask)
+{
+  return (uint8_t)__builtin_popcount(mask);
+}
+
+static SensorHealth classify()
+{
+  if (consecStuck >= Health::STUCK_PINGS)
+    return SH_STUCK;
+  if (consecDead >= Health::DEAD_PINGS)
+    return SH_DEAD;
+  if (bitCount(maskTimeout | maskSpurious) >= Health::DEGRADED_FAULTS)
+    return SH_DEGRADED;
+  return SH_OK;
+}
+
+static HealthAction recoverAction()
+{
+  if (health != SH_STUCK && health != SH_DEAD)
+    return HA_NONE;
+
+  // 5 s, 10 s, 20 s ... 60 s between attempts
+  uint64_t interval = min<uint64_t>(Health::RETRY_MIN_MS << min<uint8_t>(recoverAttempts - 1, 4), Health::RETRY_MAX_MS);
+  if (recoverAttempts > 0 && !elapsedMs(prevRecoverMs, interval))
+    return HA_NONE;
+
+  prevRecoverMs = nowMs();
+  stats.recoveries++;
+  return (recoverAttempts++ == 0 || !powerCycleOk) ? HA_REINIT : HA_POWER_CYCLE;
+}
+
+// canPowerCycle : SENSOR_POWER_SWITCH, the history is cleared
+void healthBegin(bool canPowerCycle)
+{
+  powerCycleOk = canPowerCycle;
+  stats = {};
+  maskTimeout = maskRange = maskSpurious = 0;
+  consecStuck = consecDead = 0;
+  health = SH_OK;
+  recoverAttempts = 0;
+}
+
+HealthAction healthPing(PingResult result, uint8_t spuriousEdges, bool echoHigh)
+{
+  const bool silent = (result == PING_TIMEOUT && spuriousEdges == 0);
+
+  maskTimeout = (maskTimeout << 1) | (result == PING_TIMEOUT);
+  maskRange = (maskRange << 1) | (result == PING_RANGE);
+  maskSpurious = (maskSpurious << 1) | (spuriousEdges > 0);
+
+  stats.pings++;
+  stats.timeouts += (result == PING_TIMEOUT);
+  stats.ranges += (result == PING_RANGE);
+  stats.spurious += spuriousEdges;
+  stats.winTimeouts = bitCount(maskTimeout);
+  stats.winRanges = bitCount(maskRange);
+  stats.winSpurious = bitCount(maskSpurious);
+
+  consecStuck = (silent && echoHigh) ? min<uint8_t>(consecStuck + 1, Health::STUCK_PINGS) : 0;
+  consecDead = (silent && !echoHigh) ? min<uint8_t>(consecDead + 1, Health::DEAD_PINGS) : 0;
+  if (result == PING_OK)
+    recoverAttempts = 0; // the sensor answers again
+
+  SensorHealth next = classify();
+  if (next != health)
+  {
+    dbPrtln("sensor health : " + String(SENSOR_HEALTH_NAME[health]) + " -> " + String(SENSOR_HEALTH_NAME[next]));
+    health = next;
+  }
+  return recoverAction();
+}
+
+SensorHealth healthState()
+{
+  return health;
+}
+
+const HealthStats &healthStats()
+{
+  return stats;
+}
@@ -0,0 +1,62 @@
+// *******************************************************
+//  N_HEALTH        HC-SR04 sensor health monitor
+// -------------------------------------------------------
+// N_health.h
+//   rolling fault rates over the last 32 pings, stuck-high
+//   and dead-sensor detection, recovery escalation
+// *******************************************************
+#ifndef _N_HEALTH_H
+#define _N_HEALTH_H
+// -------------------------------------------------------
+#include "N_util.h"
+
+// Grove 5V switchable by setExtOutput() : not on the Cardputer, whose
+// port is fed by the always-on boost converter
+#ifndef SENSOR_POWER_SWITCH
+#define SENSOR_POWER_SWITCH 0
+#endif
+
+enum PingResult : uint8_t
+{
+  PING_OK,      // valid echo
+  PING_RANGE,   // echo out of range (zero or too long)
+  PING_TIMEOUT, // no echo before the timeout
+};
+
+enum SensorHealth : uint8_t
+{
+  SH_OK,
+  SH_DEGRADED, // too many faults in the window
+  SH_STUCK,    // echo line stays high
+  SH_DEAD,     // no edge at all
+  SH_NUM
+};
+
+enum HealthAction : uint8_t
+{
+  HA_NONE,
+  HA_REINIT,      // re-initialise the pins and re-attach the ISR
+  HA_POWER_CYCLE, // switch the Grove 5V off and on (SENSOR_POWER_SWITCH only)
+};
+
+struct HealthStats
+{
+  uint32_t pings;
+  uint32_t timeouts;
+  uint32_t ranges;
+  uint32_t spurious;   // ISR edges besides the rising / falling edge of an echo
+  uint32_t recoveries; // recovery actions taken
+  uint8_t winTimeouts; // in the last HEALTH_WINDOW pings
+  uint8_t winRanges;
+  uint8_t winSpurious; // pings with spurious edges
+};
+
+constexpr uint8_t HEALTH_WINDOW = 32;
+extern const char *SENSOR_HEALTH_NAME[];
+extern void healthBegin(bool canPowerCycle);
+extern HealthAction healthPing(PingResult result, uint8_t spuriousEdges, bool echoHigh);
+extern SensorHealth healthState();
+extern const HealthStats &healthStats();
+
+// -------------------------------------------------------
+#endif // _N_HEALTH_H
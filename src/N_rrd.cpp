@@ -0,0 +1,207 @@
+#include "N_rrd.h"
+
+// ------------------------------------------------------------------------
+// Round-robin time-series store
+// ------------------------------------------------------------------------
+// Every sample goes into the raw ring and the open 1-minute bucket.
+// When a period ends its bucket is pushed into the tier's ring and
+// merged into the open bucket of the next tier, so each sample costs
+// O(1) and RAM is fixed (RrdState). Periods without samples are kept
+// as empty buckets (count = 0) to keep the rings aligned in time.
+//
+// Time is "store time" : seconds of monitoring, continued across
+// power cycles from the last checkpoint (the Cardputer has no RTC).
+// The whole state is checkpointed to NVS as one blob.
+// ------------------------------------------------------------------------
+namespace Rrd
+{
+  constexpr uint16_t RAW_LEN = 60;     // last 60 samples
+  constexpr uint16_t MINUTE_LEN = 60;  // 1 hour
+  constexpr uint16_t HOUR_LEN = 168;   // 7 days
+  constexpr uint16_t DAY_LEN = 60;     // 60 days
+  constexpr uint32_t PERIOD_S[RRD_TIER_NUM] = {0, 60, 3600, 86400};
+  constexpr uint64_t CHECKPOINT_INTERVAL_MS = 10 * 60 * 1000ULL;
+  constexpr uint32_t MAGIC = 0x52524401; // "RRD" + layout version
+}
+
+struct RrdState
+{
+  uint32_t magic;
+  uint32_t clock_s;                 // store time at checkpoint
+  uint32_t curIdx[RRD_TIER_NUM];    // period number of the open bucket
+  RrdBucket cur[RRD_TIER_NUM];      // open buckets (not used for RRD_RAW)
+  uint16_t head[RRD_TIER_NUM];      // next write position
+  uint16_t count[RRD_TIER_NUM];     // closed buckets in the ring
+  RrdBucket raw[Rrd::RAW_LEN];
+  RrdBucket minute[Rrd::MINUTE_LEN];
+  RrdBucket hour[Rrd::HOUR_LEN];
+  RrdBucket day[Rrd::DAY_LEN];
+};
+
+const char *RRD_TIER_NAME[] = {"raw", "1 min", "1 hour", "1 day"};
+static const char *NVM_RRD = "rrd";
+static RrdState rrd;
+static RrdBucket *const RRD_RING[RRD_TIER_NUM] = {rrd.raw, rrd.minute, rrd.hour, rrd.day};
+static const uint16_t RRD_LEN[RRD_TIER_NUM] = {Rrd::RAW_LEN, Rrd::MINUTE_LEN, Rrd::HOUR_LEN, Rrd::DAY_LEN};
+static uint32_t rrdClockBase = 0; // store time at boot
+static uint64_t prevCheckpointMs = 0;
+
+static uint32_t rrdNow()
+{
+  return rrdClockBase + (uint32_t)(nowMs() / 1000ULL);
+}
+
+static void bucketClear(RrdBucket &b)
+{
+  b.min = 0.0f;
+  b.max = 0.0f;
+  b.sum = 0.0f;
+  b.count = 0;
+}
+
+static void bucketMerge(RrdBucket &to, const RrdBucket &from)
+{
+  if (from.count == 0)
+    return;
+  if (to.count == 0)
+  {
+    to = from;
+    return;
+  }
+  if (from.min < to.min)
+    to.min = from.min;
+  if (from.max > to.max)
+    to.max = from.max;
+  to.sum += from.sum;
+  to.count += from.count;
+}
+
+static void ringPush(RrdTier tier, const RrdBucket &b)
+{
+  RRD_RING[tier][rrd.head[tier]] = b;
+  rrd.head[tier] = (rrd.head[tier] + 1) % RRD_LEN[tier];
+  if (rrd.count[tier] < RRD_LEN[tier])
+    rrd.count[tier]++;
+}
+
+// close every period that ended before t_s
+static void rrdAdvance(uint32_t t_s)
+{
+  for (uint8_t tier = RRD_MINUTE; tier < RRD_TIER_NUM; ++tier)
+  {
+    uint32_t idx = t_s / Rrd::PERIOD_S[tier];
+    if (idx == rrd.curIdx[tier])
+      break; // longer periods cannot have ended either
+
+    ringPush((RrdTier)tier, rrd.cur[tier]);
+    if (tier + 1 < RRD_TIER_NUM)
+      bucketMerge(rrd.cur[tier + 1], rrd.cur[tier]);
+
+    // periods without any sample
+    RrdBucket empty;
+    bucketClear(empty);
+    uint32_t gaps = min<uint32_t>(idx - rrd.curIdx[tier] - 1, RRD_LEN[tier]);
+    for (uint32_t i = 0; i < gaps; ++i)
+      ringPush((RrdTier)tier, empty);
+
+    bucketClear(rrd.cur[tier]);
+    rrd.curIdx[tier] = idx;
+  }
+}
+
+static void rrdClear()
+{
+  memset(&rrd, 0, sizeof(rrd));
+  rrd.magic = Rrd::MAGIC;
+  for (uint8_t tier = RRD_MINUTE; tier < RRD_TIER_NUM; ++tier)
+  {
+    rrd.curIdx[tier] = 0;
+    bucketClear(rrd.cur[tier]);
+  }
+}
+
+void rrdBegin()
+{
+  if (!rdNVSBlob(NVM_RRD, &rrd, sizeof(rrd)) || rrd.magic != Rrd::MAGIC)
+  {
+    dbPrtln("rrd: new store");
+    rrdClear();
+  }
+  rrdClockBase = rrd.clock_s;
+  prevCheckpointMs = nowMs();
+  rrdAdvance(rrdNow());
+  dbPrtln("rrd: store time " + String(rrdClockBase) + " s, " + String((unsigned)sizeof(rrd)) + " bytes");
+}
+
+void rrdAdd(float value)
+{
+  rrdAdvance(rrdNow());
+
+  RrdBucket b = {value, value, value, 1};
+  ringPush(RRD_RAW, b);
+  bucketMerge(rrd.cur[RRD_MINUTE], b);
+}
+
+void rrdService()
+{
+  // call from loop() : closes periods on time (also without samples)
+  // and checkpoints every CHECKPOINT_INTERVAL_MS
+  rrdAdvance(rrdNow());
+  if (!elapsedMs(prevCheckpointMs, Rrd::CHECKPOINT_INTERVAL_MS))
+    return;
+  rrdCheckpoint();
+}
+
+void rrdCheckpoint()
+{
+  rrdAdvance(rrdNow());
+  rrd.clock_s = rrdNow();
+  prevCheckpointMs = nowMs();
+  if (wrtNVSBlob(NVM_RRD, &rrd, sizeof(rrd)))
+    dbPrtln("rrd: checkpoint at " + String(rrd.clock_s) + " s");
+}
+
+uint16_t rrdCount(RrdTier tier)
+{
+  // aggregate tiers also expose the open (in progress) bucket
+  return rrd.count[tier] + (tier == RRD_RAW ? 0 : 1);
+}
+
+bool rrdGet(RrdTier tier, uint16_t age, RrdBucket &bucket)
+{
+  // age 0 : newest (the open bucket on aggregate tiers)
+  if (age >= rrdCount(tier))
+    return false;
+
+  if (tier != RRD_RAW)
+  {
+    if (age == 0)
+    {
+      bucket = rrd.cur[tier];
+      return true;
+    }
+    age--;
+  }
+  uint16_t pos = (rrd.head[tier] + RRD_LEN[tier] - 1 - age) % RRD_LEN[tier];
+  bucket = RRD_RING[tier][pos];
+  return true;
+}
+
+void rrdExport(Print &out)
+{
+  // CSV, newest first per tier; read from the tiers only
+  rrdAdvance(rrdNow());
+  out.printf("# rrd export, store time %u s\n", (unsigned)rrdNow());
+  out.println("tier,age,min,max,mean,count");
+  for (uint8_t tier = 0; tier < RRD_TIER_NUM; ++tier)
+  {
+    RrdBucket b;
+    for (uint16_t age = 0; rrdGet((RrdTier)tier, age, b); ++age)
+    {
+      if (b.count == 0)
+        out.printf("%s,%u,,,,0\n", RRD_TIER_NAME[tier], age);
+      else
+        out.printf("%s,%u,%.1f,%.1f,%.1f,%u\n", RRD_TIER_NAME[tier], age, b.min, b.max, b.sum / b.count, (unsigned)b.count);
+    }
+  }
+}
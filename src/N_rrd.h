@@ -0,0 +1,40 @@
+// *******************************************************
+//  N_RRD           round-robin time-series store
+// -------------------------------------------------------
+// N_rrd.h
+//   tiers : raw samples, 1-minute, 1-hour, 1-day buckets
+//   each bucket holds min / max / sum(mean) / count
+// *******************************************************
+#ifndef _N_RRD_H
+#define _N_RRD_H
+// -------------------------------------------------------
+#include "N_util.h"
+
+enum RrdTier : uint8_t
+{
+  RRD_RAW,
+  RRD_MINUTE,
+  RRD_HOUR,
+  RRD_DAY,
+  RRD_TIER_NUM
+};
+
+struct RrdBucket
+{
+  float min;
+  float max;
+  float sum; // mean = sum / count
+  uint32_t count;
+};
+
+extern const char *RRD_TIER_NAME[];
+extern void rrdBegin();
+extern void rrdAdd(float value);
+extern void rrdService();
+extern void rrdCheckpoint();
+extern uint16_t rrdCount(RrdTier tier);
+extern bool rrdGet(RrdTier tier, uint16_t age, RrdBucket &bucket);
+extern void rrdExport(Print &out);
+
+// -------------------------------------------------------
+#endif // _N_RRD_H
@@ -1,6 +1,10 @@
 #include "N_util.h"
+#include "l10n_fonts.h"
 #include <M5StackUpdater.h>
 #include <WiFi.h> // Added for WiFi.mode(WIFI_OFF)
+#ifdef CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
 
 M5Canvas canvas(&M5Cardputer.Display);
 static SPIClass SPI2;
@@ -17,6 +21,17 @@ int32_t W_CHR, H_CHR;      // Character dimensions
 int32_t X_WIDTH, Y_HEIGHT; // Screen dimensions
 int32_t SC_LINES[N_ROWS];  // Array to store Y coordinates of each line
 
+//---- UI colours ---------------------------------------
+// RGB565 for the 8-bit canvas, palette index for 4/2-bit.
+// A 2-bit palette has 4 entries : green -> sky blue, red -> orange.
+static const uint16_t UI_COLOR_RGB565[UC_NUM] = {TFT_BLACK, TFT_WHITE, TFT_SKYBLUE, TFT_GREEN, TFT_ORANGE, TFT_RED};
+static const uint32_t UI_COLOR_RGB888[UC_NUM] = {0x000000u, 0xFFFFFFu, 0x87CEEBu, 0x00FF00u, 0xFFA500u, 0xFF0000u};
+#if CANVAS_COLOR_DEPTH == 2
+static const uint8_t UI_COLOR_INDEX[UC_NUM] = {0, 1, 2, 2, 3, 3};
+#else
+static const uint8_t UI_COLOR_INDEX[UC_NUM] = {0, 1, 2, 3, 4, 5};
+#endif
+
 // #define PLATFORMIO_IDE_DEBUG
 void m5stack_begin()
 {
@@ -42,11 +57,8 @@ void m5stack_begin()
   dbPrtln("Wi-Fi and Bluetooth disabled.");
 
   // Reduce power consumption by lowering CPU frequency (e.g., 80MHz)
-  if (setCpuFrequencyMhz(80))
-  {
-    dbPrtln("CPU Freq set to: " + String(getCpuFrequencyMhz()) + " MHz");
-  }
-
+  // ** policy setup at settingsInit() **
+  cpuGovBegin();
 
   // Calculate Cardputer specific display scale parameters
   X_WIDTH = M5Cardputer.Display.width();
@@ -65,14 +77,24 @@ void m5stack_begin()
   M5Cardputer.Display.setColorDepth(8);
   M5Cardputer.Display.setRotation(1);
   
-  canvas.setColorDepth(8);
+  canvas.setColorDepth(CANVAS_COLOR_DEPTH);
   canvas.createSprite(X_WIDTH, Y_HEIGHT);
-  canvas.fillScreen(TFT_BLACK);
-  canvas.setFont(&fonts::lgfxJapanGothic_16); // default japanese font
+#if CANVAS_COLOR_DEPTH < 8
+  canvas.createPalette();
+  for (int i = 0; i < UC_NUM; ++i)
+  {
+    if (i > 0 && UI_COLOR_INDEX[i] == UI_COLOR_INDEX[i - 1])
+      continue; // aliased (2-bit) : the entry keeps the first colour
+    canvas.setPaletteColor(UI_COLOR_INDEX[i], UI_COLOR_RGB888[i]);
+  }
+#endif
+  dbPrtln("canvas: " + String(CANVAS_COLOR_DEPTH) + "-bit, " + String((unsigned long)canvas.bufferLength()) + " bytes");
+  canvas.fillScreen(uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_G16); // default japanese font (subset)
   canvas.setTextSize(1);
   canvas.setTextDatum(top_left); // character base position
   canvas.setTextWrap(false);
-  canvas.setTextColor(TFT_WHITE, TFT_BLACK);
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
   canvas.setCursor(0, 0);
   // canvas.pushSprite(0, 0);
 
@@ -86,6 +108,15 @@ void m5stack_begin()
   SD_ENABLE = SD_begin();
 }
 
+uint16_t uiColor(UiColor c)
+{
+#if CANVAS_COLOR_DEPTH < 8
+  return UI_COLOR_INDEX[c];
+#else
+  return UI_COLOR_RGB565[c];
+#endif
+}
+
 // ------------------------------------------------------------------------
 // SDU_lobby :  lobby for M5Stack-SD-Updater
 // ------------------------------------------------------------------------
@@ -147,7 +178,7 @@ void dispLx(uint8_t Lx, const char *msg)
   if (Lx >= N_ROWS)
     return;
 
-  canvas.fillRect(0, SC_LINES[Lx], X_WIDTH, H_CHR, TFT_BLACK);
+  canvas.fillRect(0, SC_LINES[Lx], X_WIDTH, H_CHR, uiColor(UC_BLACK));
   canvas.setCursor(0, SC_LINES[Lx]);
   canvas.print(msg);
 }
@@ -198,6 +229,48 @@ bool rdNVS(const char *title, uint8_t &data)
   return false;
 }
 
+bool wrtNVSBlob(const char *title, const void *data, size_t len)
+{
+  nvs_handle_t nvs_handle;
+  esp_err_t err = nvs_open(NVS_SETTING, NVS_READWRITE, &nvs_handle);
+  if (err == ESP_OK)
+  {
+    err = nvs_set_blob(nvs_handle, title, data, len);
+    if (err == ESP_OK)
+      err = nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+    if (err == ESP_OK)
+      return true;
+    dbPrtln("ERR: NVS blob write failed: " + String(esp_err_to_name(err)));
+  }
+  else
+  {
+    dbPrtln("ERR: NVS open for write failed: " + String(esp_err_to_name(err)));
+  }
+  return false;
+}
+
+bool rdNVSBlob(const char *title, void *data, size_t len)
+{
+  // true only if a blob of exactly len bytes was read
+  nvs_handle_t nvs_handle;
+  esp_err_t err = nvs_open(NVS_SETTING, NVS_READONLY, &nvs_handle);
+  if (err == ESP_OK)
+  {
+    size_t stored_len = 0;
+    err = nvs_get_blob(nvs_handle, title, nullptr, &stored_len);
+    if (err == ESP_OK && stored_len == len)
+      err = nvs_get_blob(nvs_handle, title, data, &stored_len);
+    nvs_close(nvs_handle);
+    return err == ESP_OK && stored_len == len;
+  }
+  else
+  {
+    dbPrtln("ERR: NVS open for read failed: " + String(esp_err_to_name(err)));
+  }
+  return false;
+}
+
 void loadSetting(const char *nvs_key, uint8_t &setting_variable, uint8_t default_value, uint8_t min_val, uint8_t max_val)
 {
   uint8_t nvmData;
@@ -220,3 +293,327 @@ void loadSetting(const char *nvs_key, uint8_t &setting_variable, uint8_t default
     wrtNVS(nvs_key, setting_variable);
   }
 }
+
+// ------------------------------------------------------------------------
+// 64-bit monotonic timebase
+// ------------------------------------------------------------------------
+// millis()/micros() are 32-bit and wrap (micros() after ~71 min).
+// esp_timer counts microseconds since boot in 64 bits (~292,000 years),
+// so every scheduler compares times with plain subtraction.
+// nowUs() is also called from ISRs, so it lives in IRAM.
+// ------------------------------------------------------------------------
+uint64_t IRAM_ATTR nowUs()
+{
+  return (uint64_t)esp_timer_get_time();
+}
+
+uint64_t nowMs()
+{
+  return nowUs() / 1000ULL;
+}
+
+bool elapsedUs(uint64_t since_us, uint64_t interval_us)
+{
+  return nowUs() - since_us >= interval_us;
+}
+
+bool elapsedMs(uint64_t since_ms, uint64_t interval_ms)
+{
+  return nowMs() - since_ms >= interval_ms;
+}
+
+// ------------------------------------------------------------------------
+// Keyboard scanning service
+// ------------------------------------------------------------------------
+// The Cardputer keyboard is a GPIO matrix without an interrupt line,
+// so a low-priority task scans it at a fixed rate instead of every
+// loop(). A change must be stable for DEBOUNCE_SCANS scans before
+// press / release events are queued; a held key auto-repeats.
+// After keyScanBegin() only this task touches M5Cardputer.Keyboard.
+// ------------------------------------------------------------------------
+namespace KeyScan
+{
+  constexpr uint32_t SCAN_INTERVAL_MS = 20;
+  constexpr uint8_t DEBOUNCE_SCANS = 2;
+  constexpr uint64_t REPEAT_DELAY_MS = 500;
+  constexpr uint64_t REPEAT_RATE_MS = 120;
+  constexpr uint8_t MAX_KEYS = 8; // simultaneous keys tracked
+  constexpr uint8_t QUEUE_LEN = 16;
+  constexpr uint32_t TASK_STACK = 3072;
+  constexpr int TASK_PRIORITY = 1;
+}
+
+struct KeySet
+{
+  uint8_t n;
+  char key[KeyScan::MAX_KEYS];
+};
+
+static QueueHandle_t keyQueue = nullptr;
+
+static bool keySetHas(const KeySet &ks, char key)
+{
+  for (uint8_t i = 0; i < ks.n; ++i)
+  {
+    if (ks.key[i] == key)
+      return true;
+  }
+  return false;
+}
+
+static bool keySetEqual(const KeySet &a, const KeySet &b)
+{
+  if (a.n != b.n)
+    return false;
+  for (uint8_t i = 0; i < a.n; ++i)
+  {
+    if (!keySetHas(b, a.key[i]))
+      return false;
+  }
+  return true;
+}
+
+static void keyScanRead(KeySet &ks)
+{
+  M5Cardputer.Keyboard.updateKeyList();
+  ks.n = 0;
+  for (const Point2D_t &pos : M5Cardputer.Keyboard.keyList())
+  {
+    if (ks.n >= KeyScan::MAX_KEYS)
+      break;
+    ks.key[ks.n++] = M5Cardputer.Keyboard.getKeyValue(pos).value_first;
+  }
+}
+
+static void keyPost(char key, KeyEventType type)
+{
+  KeyEvent ev = {key, type};
+  if (xQueueSend(keyQueue, &ev, 0) != pdTRUE)
+    dbPrtln("ERR: key queue full");
+}
+
+static void keyScanTask(void *)
+{
+  KeySet stable = {};    // debounced state
+  KeySet candidate = {}; // last raw state
+  KeySet raw;
+  uint8_t stableScans = 0;
+  char repeatKey = 0;
+  uint64_t repeatAt = 0;
+  TickType_t wake = xTaskGetTickCount();
+
+  for (;;)
+  {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(KeyScan::SCAN_INTERVAL_MS));
+    keyScanRead(raw);
+
+    if (!keySetEqual(raw, candidate))
+    {
+      candidate = raw;
+      stableScans = 1;
+    }
+    else if (stableScans < KeyScan::DEBOUNCE_SCANS)
+    {
+      stableScans++;
+    }
+
+    if (stableScans >= KeyScan::DEBOUNCE_SCANS && !keySetEqual(candidate, stable))
+    {
+      for (uint8_t i = 0; i < stable.n; ++i)
+      {
+        if (!keySetHas(candidate, stable.key[i]))
+          keyPost(stable.key[i], KE_RELEASE);
+      }
+      for (uint8_t i = 0; i < candidate.n; ++i)
+      {
+        if (!keySetHas(stable, candidate.key[i]))
+        { // the newest key pressed is the one that repeats
+          keyPost(candidate.key[i], KE_PRESS);
+          repeatKey = candidate.key[i];
+          repeatAt = nowMs() + KeyScan::REPEAT_DELAY_MS;
+        }
+      }
+      stable = candidate;
+      if (!keySetHas(stable, repeatKey))
+        repeatKey = 0;
+    }
+
+    if (repeatKey != 0 && nowMs() >= repeatAt)
+    {
+      keyPost(repeatKey, KE_REPEAT);
+      repeatAt += KeyScan::REPEAT_RATE_MS;
+    }
+  }
+}
+
+void keyScanBegin()
+{
+  if (keyQueue != nullptr)
+    return;
+  keyQueue = xQueueCreate(KeyScan::QUEUE_LEN, sizeof(KeyEvent));
+  if (keyQueue == nullptr)
+  {
+    dbPrtln("ERR: key queue create failed");
+    return;
+  }
+  if (xTaskCreatePinnedToCore(keyScanTask, "keyScan", KeyScan::TASK_STACK, nullptr, KeyScan::TASK_PRIORITY, nullptr, ARDUINO_RUNNING_CORE) != pdPASS)
+    dbPrtln("ERR: key scan task create failed");
+}
+
+bool getKeyEvent(KeyEvent &ev)
+{
+  // non-blocking : true if an event was taken from the queue
+  if (keyQueue == nullptr)
+    return false;
+  return xQueueReceive(keyQueue, &ev, 0) == pdTRUE;
+}
+
+// ------------------------------------------------------------------------
+// CPU frequency governor
+// ------------------------------------------------------------------------
+// CPU_AUTO runs at MIN_MHZ and raises the clock to MAX_MHZ only while
+// a cpuBoost() / cpuRelax() pair (or CpuBoostScope) is active.
+// With CONFIG_PM_ENABLE the ESP-IDF power management lock is used,
+// otherwise setCpuFrequencyMhz() (Arduino prebuilt core).
+// MIN_MHZ is 80 : lower clocks also slow down APB (SPI, UART).
+//
+// Energy per sample is an estimate : time at each clock x CPU power
+// from the ESP32-S3 datasheet (active, radio off). Display and
+// sensor power are not included.
+// ------------------------------------------------------------------------
+namespace CpuGov
+{
+  constexpr uint32_t MIN_MHZ = 80;
+  constexpr uint32_t MAX_MHZ = 240;
+  constexpr uint32_t POWER_MW_MIN = 76;  // ~23 mA @ 3.3 V
+  constexpr uint32_t POWER_MW_MAX = 145; // ~44 mA @ 3.3 V
+}
+
+const char *CPU_POLICY_NAME[] = {"low", "auto", "high"};
+static uint8_t cpuPolicy = CPU_LOW;
+static uint8_t cpuBoostDepth = 0;
+static uint32_t cpuMhz = CpuGov::MIN_MHZ; // clock the energy is accounted at
+static uint64_t cpuAcctUs = 0;
+static uint64_t cpuEnergy_nJ = 0;
+static uint32_t cpuSamples = 0;
+#ifdef CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t cpuLock = nullptr;
+#endif
+
+static uint32_t cpuPowerMw(uint32_t mhz)
+{
+  return CpuGov::POWER_MW_MIN + (CpuGov::POWER_MW_MAX - CpuGov::POWER_MW_MIN) * (mhz - CpuGov::MIN_MHZ) / (CpuGov::MAX_MHZ - CpuGov::MIN_MHZ);
+}
+
+static void cpuAccount(uint32_t new_mhz)
+{
+  uint64_t now = nowUs();
+  cpuEnergy_nJ += (now - cpuAcctUs) * cpuPowerMw(cpuMhz); // [us] x [mW] = [nJ]
+  cpuAcctUs = now;
+  cpuMhz = new_mhz;
+}
+
+static void cpuClockUp()
+{
+#ifdef CONFIG_PM_ENABLE
+  if (cpuLock != nullptr)
+    esp_pm_lock_acquire(cpuLock);
+#else
+  setCpuFrequencyMhz(CpuGov::MAX_MHZ);
+#endif
+  cpuAccount(CpuGov::MAX_MHZ);
+}
+
+static void cpuClockDown()
+{
+#ifdef CONFIG_PM_ENABLE
+  if (cpuLock != nullptr)
+    esp_pm_lock_release(cpuLock);
+#else
+  setCpuFrequencyMhz(CpuGov::MIN_MHZ);
+#endif
+  cpuAccount(CpuGov::MIN_MHZ);
+}
+
+void cpuGovBegin()
+{
+#ifdef CONFIG_PM_ENABLE
+  esp_err_t err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "cpuBoost", &cpuLock);
+  if (err != ESP_OK)
+  {
+    dbPrtln("ERR: PM lock create failed: " + String(esp_err_to_name(err)));
+    cpuLock = nullptr;
+  }
+#endif
+  cpuAcctUs = nowUs();
+  cpuMhz = getCpuFrequencyMhz();
+  cpuSetPolicy(CPU_LOW);
+}
+
+void cpuSetPolicy(uint8_t policy)
+{
+  if (policy >= CPU_POLICY_NUM)
+    policy = CPU_LOW;
+
+  // drop an active boost of the old policy, take it again under the new one
+  if (cpuPolicy == CPU_AUTO && cpuBoostDepth > 0)
+    cpuClockDown();
+  cpuPolicy = policy;
+
+  uint32_t min_mhz = (policy == CPU_HIGH) ? CpuGov::MAX_MHZ : CpuGov::MIN_MHZ;
+  uint32_t max_mhz = (policy == CPU_LOW) ? CpuGov::MIN_MHZ : CpuGov::MAX_MHZ;
+#ifdef CONFIG_PM_ENABLE
+  esp_pm_config_esp32s3_t pm_config = {};
+  pm_config.max_freq_mhz = max_mhz;
+  pm_config.min_freq_mhz = min_mhz;
+  pm_config.light_sleep_enable = false;
+  esp_err_t err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK)
+    dbPrtln("ERR: PM configure failed: " + String(esp_err_to_name(err)));
+#else
+  setCpuFrequencyMhz(min_mhz);
+#endif
+  cpuAccount(min_mhz);
+  if (cpuPolicy == CPU_AUTO && cpuBoostDepth > 0)
+    cpuClockUp();
+
+  // energy statistics are per policy
+  cpuEnergy_nJ = 0;
+  cpuSamples = 0;
+  dbPrtln("CPU policy: " + String(CPU_POLICY_NAME[policy]) + " (" + String(min_mhz) + "-" + String(max_mhz) + " MHz)");
+}
+
+uint8_t cpuGetPolicy()
+{
+  return cpuPolicy;
+}
+
+void cpuBoost()
+{
+  if (cpuBoostDepth++ > 0 || cpuPolicy != CPU_AUTO)
+    return;
+  cpuClockUp();
+}
+
+void cpuRelax()
+{
+  if (cpuBoostDepth == 0)
+    return;
+  if (--cpuBoostDepth > 0 || cpuPolicy != CPU_AUTO)
+    return;
+  cpuClockDown();
+}
+
+void cpuGovSample()
+{
+  cpuSamples++;
+}
+
+double cpuEnergyPerSample()
+{
+  // [mJ] per sample since the policy was set
+  cpuAccount(cpuMhz); // bring the energy up to now
+  if (cpuSamples == 0)
+    return NAN;
+  return (double)cpuEnergy_nJ / 1e6 / cpuSamples;
+}
@@ -9,9 +9,28 @@
 #include <Arduino.h>
 #include <SD.h>
 #include <nvs.h>
+#include <esp_timer.h>
 #include <M5Cardputer.h>
 #include <M5GFX.h>
 
+// --- canvas colour depth ---
+// 8 : RGB332 sprite / 4, 2 : palette-indexed sprite (fixed UI palette)
+#ifndef CANVAS_COLOR_DEPTH
+#define CANVAS_COLOR_DEPTH 4
+#endif
+
+// UI colours : draw with uiColor(UC_xxx), never with TFT_xxx directly
+enum UiColor : uint8_t
+{
+  UC_BLACK,
+  UC_WHITE,
+  UC_SKYBLUE,
+  UC_GREEN,
+  UC_ORANGE,
+  UC_RED,
+  UC_NUM
+};
+
 extern M5Canvas canvas;
 extern bool SD_ENABLE;
 extern const int32_t N_COLS, N_ROWS;
@@ -20,6 +39,7 @@ extern int32_t X_WIDTH, Y_HEIGHT;   // Screen dimensions
 extern int32_t SC_LINES[];          // Array to store Y coordinates of each line
 
 extern void m5stack_begin();
+extern uint16_t uiColor(UiColor c);
 extern void SDU_lobby();
 extern bool SD_begin();
 extern void dbPrtln(String msg);
@@ -28,7 +48,56 @@ extern void dispLx(uint8_t Lx, const char *msg);
 extern void POWER_OFF();
 extern bool wrtNVS(const char *title, uint8_t data);
 extern bool rdNVS(const char *title, uint8_t &data);
+extern bool wrtNVSBlob(const char *title, const void *data, size_t len);
+extern bool rdNVSBlob(const char *title, void *data, size_t len);
 extern void loadSetting(const char *nvs_key, uint8_t &setting_variable, uint8_t default_value, uint8_t min_val, uint8_t max_val);
 
+// --- 64-bit monotonic timebase (esp_timer : does not wrap in practice) ---
+extern uint64_t nowUs();
+extern uint64_t nowMs();
+extern bool elapsedUs(uint64_t since_us, uint64_t interval_us);
+extern bool elapsedMs(uint64_t since_ms, uint64_t interval_ms);
+
+// --- keyboard scanning service ---
+enum KeyEventType : uint8_t
+{
+  KE_PRESS,
+  KE_RELEASE,
+  KE_REPEAT // key held : sent after REPEAT_DELAY_MS, then every REPEAT_RATE_MS
+};
+
+struct KeyEvent
+{
+  char key; // KeyValue_t.value_first (no shift / fn)
+  KeyEventType type;
+};
+
+extern void keyScanBegin();
+extern bool getKeyEvent(KeyEvent &ev);
+
+// --- CPU frequency governor ---
+enum CpuPolicy : uint8_t
+{
+  CPU_LOW,  // fixed minimum clock
+  CPU_AUTO, // minimum clock when idle, maximum during render / push bursts
+  CPU_HIGH, // fixed maximum clock
+  CPU_POLICY_NUM
+};
+extern const char *CPU_POLICY_NAME[];
+extern void cpuGovBegin();
+extern void cpuSetPolicy(uint8_t policy);
+extern uint8_t cpuGetPolicy();
+extern void cpuBoost();
+extern void cpuRelax();
+extern void cpuGovSample();
+extern double cpuEnergyPerSample();
+
+// raise the clock for the lifetime of a scope (CPU_AUTO only)
+struct CpuBoostScope
+{
+  CpuBoostScope() { cpuBoost(); }
+  ~CpuBoostScope() { cpuRelax(); }
+};
+
 // -------------------------------------------------------
 #endif // _N_UTIL_H
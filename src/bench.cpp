@@ -0,0 +1,93 @@
+// *******************************************************
+//  Render-path microbenchmark   ( build : -DBENCH )
+// -------------------------------------------------------
+// bench.cpp
+//   pio run -e cardputer-bench -t upload -t monitor
+// Each render routine runs in a tight loop with changing
+// inputs, timed with the CPU cycle counter (CCOUNT).
+// Results : median and p99 per call, printed to Serial.
+// The run is pinned to CPU_HIGH : under CPU_AUTO a routine
+// would switch the clock inside its own timed call.
+// Device only : the native env (test/sim) draws nothing,
+// so host timings would not say anything about the S3.
+// *******************************************************
+#ifdef BENCH
+#include "N_util.h"
+
+// --- render routines under test (main.cpp) ---
+extern void prtDistance(double temp_val);
+extern void prtVelocity(double velocity);
+extern void prtBatLvl(uint8_t batLvl);
+extern void dispMeasItem();
+extern void dispBatItem();
+extern void dispInit();
+
+namespace BenchConfig
+{
+  constexpr int LOOPS = 200;  // calls per routine
+  constexpr int WARM_UP = 8;  // untimed calls (cache / font warm-up)
+}
+
+static uint32_t samples[BenchConfig::LOOPS];
+static uint32_t benchMhz = 0; // fixed clock of the run
+
+// Run fn(i) LOOPS times and print one table row
+template <typename Fn>
+static void benchRow(const char *name, Fn fn)
+{
+  for (int i = 0; i < BenchConfig::WARM_UP; ++i)
+    fn(i);
+
+  for (int i = 0; i < BenchConfig::LOOPS; ++i)
+  {
+    uint32_t start = ESP.getCycleCount();
+    fn(i);
+    samples[i] = ESP.getCycleCount() - start; // 32-bit wrap safe
+  }
+  std::sort(samples, samples + BenchConfig::LOOPS);
+
+  const uint32_t mhz = benchMhz;
+  const uint32_t median = samples[BenchConfig::LOOPS / 2];
+  const uint32_t p99 = samples[(BenchConfig::LOOPS * 99) / 100];
+  Serial.printf("%-16s %10u %10.1f %10u %10.1f\n", name,
+                median, (double)median / mhz, p99, (double)p99 / mhz);
+}
+
+void runBench()
+{
+  // Representative inputs : values change every call, so the
+  // "skip if unchanged" caches in the routines never short-circuit.
+  static const double distances[] = {3.2, 45.7, 123.4, 399.9, NAN};
+  static const double velocities[] = {-12.5, 0.0, 3.4, 101.2, NAN};
+  const int nDist = sizeof(distances) / sizeof(distances[0]);
+  const int nVelo = sizeof(velocities) / sizeof(velocities[0]);
+
+  // fixed clock for the whole run, the user's policy is restored afterwards
+  const uint8_t policy = cpuGetPolicy();
+  cpuSetPolicy(CPU_HIGH);
+  benchMhz = getCpuFrequencyMhz();
+
+  Serial.printf("\n*** render bench : CPU %s, %u MHz, %d-bit canvas (%u bytes), %d loops ***\n",
+                CPU_POLICY_NAME[CPU_HIGH], benchMhz, CANVAS_COLOR_DEPTH, (unsigned)canvas.bufferLength(), BenchConfig::LOOPS);
+  Serial.printf("%-16s %10s %10s %10s %10s\n", "routine", "med[cyc]", "med[us]", "p99[cyc]", "p99[us]");
+
+  benchRow("prtDistance", [&](int i)
+           { prtDistance(distances[i % nDist]); });
+  benchRow("prtVelocity", [&](int i)
+           { prtVelocity(velocities[i % nVelo]); });
+  benchRow("prtBatLvl", [](int i)
+           { prtBatLvl(i & 1 ? 100 : 7); }); // includes its own pushSprite
+  benchRow("dispMeasItem", [](int)
+           { dispMeasItem(); });
+  benchRow("dispBatItem", [](int)
+           { dispBatItem(); });
+  benchRow("dispInit", [](int)
+           { dispInit(); });
+  benchRow("pushSprite", [](int)
+           { canvas.pushSprite(0, 0); });
+
+  Serial.println("*** render bench end ***\n");
+  cpuSetPolicy(policy);
+  dispInit();
+}
+#endif // BENCH
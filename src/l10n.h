@@ -0,0 +1,42 @@
+// *******************************************************
+//  L10N            compile-time message tables
+// -------------------------------------------------------
+// l10n.h
+//   MSG(id, English, Japanese) : one line per message
+//   add a language : add a column, a MSG_TABLE row
+//   and raise LANG_NUM
+// ** tools/gen_l10n_fonts.py reads this table to build **
+// ** the font subsets and text widths (l10n_fonts.h)     **
+// *******************************************************
+#ifndef _L10N_H
+#define _L10N_H
+// -------------------------------------------------------
+#include <stdint.h>
+
+#define L10N_MESSAGES                      \
+  MSG(MSG_LANG_NAME, "English", "日本語")  \
+  MSG(MSG_BAT, "bat.", "電池")             \
+  MSG(MSG_DISTANCE, "Distance", "距離")    \
+  MSG(MSG_PLUS_MINUS, "±", "±")
+
+enum MsgId : uint8_t
+{
+#define MSG(id, en, ja) id,
+  L10N_MESSAGES
+#undef MSG
+  MSG_NUM
+};
+
+constexpr uint8_t LANG_NUM = 2; // 0:English 1:Japanese
+
+constexpr const char *MSG_TABLE[LANG_NUM][MSG_NUM] = {
+#define MSG(id, en, ja) en,
+    {L10N_MESSAGES},
+#undef MSG
+#define MSG(id, en, ja) ja,
+    {L10N_MESSAGES},
+#undef MSG
+};
+
+// -------------------------------------------------------
+#endif // _L10N_H
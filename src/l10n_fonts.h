@@ -0,0 +1,26 @@
+// *******************************************************
+//  L10N fonts      subsetted Japanese fonts
+// -------------------------------------------------------
+// l10n_fonts.h
+//   defined in l10n_fonts.gen.cpp, generated at build time
+//   by tools/gen_l10n_fonts.py (pre script, platformio.ini)
+//   - ASCII / Latin-1 glyphs + the glyphs used in l10n.h
+//   - the full M5GFX fonts with custom_l10n_full_fonts
+//     = yes (widths are then -1)
+// *******************************************************
+#ifndef _L10N_FONTS_H
+#define _L10N_FONTS_H
+// -------------------------------------------------------
+#include <M5GFX.h>
+#include "l10n.h"
+
+extern const lgfx::IFont *const L10N_FONT_G12; // lgfxJapanGothic_12
+extern const lgfx::IFont *const L10N_FONT_G16; // lgfxJapanGothic_16
+extern const lgfx::IFont *const L10N_FONT_G24; // lgfxJapanGothic_24
+extern const lgfx::IFont *const L10N_FONT_M16; // lgfxJapanMincho_16
+
+// textWidth() of each message in L10N_FONT_G24 (-1 : unknown)
+extern const int16_t L10N_WIDTH_G24[LANG_NUM][MSG_NUM];
+
+// -------------------------------------------------------
+#endif // _L10N_FONTS_H
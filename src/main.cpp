@@ -7,6 +7,9 @@
 //  MIT License
 // --------------------------------------------------------
 #include "N_util.h"
+#include "N_rrd.h"
+#include "N_health.h"
+#include "l10n_fonts.h"
 enum KeyNum
 {
   KN_NONE,
@@ -21,7 +24,11 @@ enum SettingMode
   SM_ESC,
   SM_BRIGHT_LEVEL,
   SM_LOWBAT_THRESHOLD,
-  SM_LANG
+  SM_LANG,
+  SM_CPU_POLICY,
+  SM_BURST_K,
+  SM_BURST_GAP,
+  SM_HISTORY
 };
 static SettingMode settingMode = SM_ESC;
 
@@ -38,29 +45,59 @@ namespace AppConfig
   constexpr uint8_t LOWBAT_THRESHOLD_MAX = 95;
   constexpr uint8_t LOWBAT_THRESHOLD_MIN = 5;
 
+  // Burst oversampling (precision mode)
+  namespace Burst
+  {
+    constexpr uint8_t K_INIT = 1; // pings per displayed value, 1 : no oversampling
+    constexpr uint8_t K_MIN = 1;
+    constexpr uint8_t K_MAX = 16;
+    constexpr uint8_t GAP_MS_INIT = 30; // quiet time after a ping before the next one
+    constexpr uint8_t GAP_MS_MIN = 10;
+    constexpr uint8_t GAP_MS_MAX = 250;
+    constexpr float OUTLIER_MADS = 3.0f;   // reject pings further from the median
+    constexpr float OUTLIER_MIN_CM = 0.5f; // floor of the rejection limit
+    constexpr float RATE_SMOOTHING = 0.2f; // EMA weight of the effective update rate
+  }
+
   // Language settings
   constexpr uint8_t LANG_INIT = 0; // 0:English 1:Japanese
-  constexpr uint8_t LANG_MAX = 1;
+  constexpr uint8_t LANG_MAX = LANG_NUM - 1;
 
   // Sensor and timing settings
   namespace Sensor
   {
-    constexpr unsigned long SR04_CHECK_INTERVAL_MS = 1 * 1000UL;
-    constexpr unsigned long SENSOR_TIMEOUT_MS = 60;
-    constexpr unsigned long MAX_ECHO_DURATION_US = 38000; // Corresponds to ~6.5m, a safe max for HC-SR04
+    constexpr uint64_t SR04_CHECK_INTERVAL_MS = 1 * 1000ULL;
+    constexpr uint64_t SENSOR_TIMEOUT_MS = 60;
+    constexpr uint64_t MIN_CYCLE_MS = SENSOR_TIMEOUT_MS; // trigger to trigger : late echoes of the last ping die out
+    constexpr uint64_t MAX_ECHO_DURATION_US = 38000; // Corresponds to ~6.5m, a safe max for HC-SR04
+    constexpr uint32_t POWER_CYCLE_OFF_MS = 200;     // Grove 5V off time of a recovery power cycle
+    constexpr uint32_t POWER_CYCLE_SETTLE_MS = 100;  // wait after power on before the next ping
+  }
+
+  // Motion estimator (approach / recede rate)
+  namespace Motion
+  {
+    constexpr uint8_t WINDOW = 8;                          // Samples in the least-squares window
+    constexpr uint8_t MIN_SAMPLES = 3;                     // Samples needed before a rate is reported
+    constexpr uint64_t MAX_GAP_US = 5 * 1000000ULL;        // Restart the fit after a gap this long
+    constexpr uint64_t REBASE_US = 60 * 1000000ULL;        // Re-base sample times to keep the sums small
   }
 
   // Battery status check
   namespace Battery
   {
     constexpr uint8_t BATLVL_FLUCTUATION_TOLERANCE = 5;
-    constexpr unsigned long BATTERY_CHECK_INTERVAL_MS = 1993UL; // Interval for battery level check
+    constexpr uint64_t BATTERY_CHECK_INTERVAL_MS = 1993ULL; // Interval for battery level check
     constexpr uint8_t LOWBAT_CONSECUTIVE_READINGS = 5;
   }
 
   // Display layout positions (in character grid)
   namespace Layout
   {
+    constexpr int HEALTH_COUNT_POS = 8;
+    constexpr int HEALTH_COUNT_LEN = 11;
+    constexpr int HEALTH_COUNT_MAX = 999;
+    constexpr int HEALTH_DOT_POS = 20;
     constexpr int BATLVL_ITEM_POS = 22;
     constexpr int BATLVL_ITEM_LEN = 4;
     constexpr int BATLVL_VALUE_POS = 26;
@@ -71,6 +108,10 @@ namespace AppConfig
     constexpr int MEAS_ITEM_POS = 2;
     constexpr int DISTANCE_FONT_SIZE = 48;
     constexpr int MEAS_ITEM_FONT_SIZE = 24;
+    constexpr int SPREAD_POS = 16;
+    constexpr int SPREAD_LEN = 7;
+    constexpr int HISTORY_GRAPH_POS = 5;
+    constexpr int HISTORY_BAR_MAX_W = 4;
   }
 }
 
@@ -79,30 +120,72 @@ const char KEY_SETTING_ESCAPE = '`';
 const char KEY_SETTING_BRIGHTNESS = '1';
 const char KEY_SETTING_LOWBAT = '2';
 const char KEY_SETTING_LANG = '3';
+const char KEY_SETTING_CPU = '4';
+const char KEY_SETTING_BURST_K = '5';
+const char KEY_SETTING_BURST_GAP = '6';
+const char KEY_HISTORY = 'h';
+const char KEY_EXPORT = 'e';
 const char KEY_UP = ';';
 const char KEY_DOWN = '.';
 const char KEY_LEFT = ',';
 const char KEY_RIGHT = '/';
 
-const char *BATLVL_TITLE[] = {"bat.", "電池"};
+// --- Key to action dispatch table ---
+enum KeyAction : uint8_t
+{
+  KA_MODE,  // enter setting mode (arg : SettingMode)
+  KA_VALUE, // adjust current setting (arg : KeyNum)
+  KA_EXPORT // dump the time-series store to Serial
+};
+
+struct KeyBinding
+{
+  char key;
+  KeyAction action;
+  uint8_t arg;
+};
+
+constexpr KeyBinding KEY_BINDINGS[] = {
+    {KEY_SETTING_ESCAPE, KA_MODE, SM_ESC},
+    {KEY_SETTING_BRIGHTNESS, KA_MODE, SM_BRIGHT_LEVEL},
+    {KEY_SETTING_LOWBAT, KA_MODE, SM_LOWBAT_THRESHOLD},
+    {KEY_SETTING_LANG, KA_MODE, SM_LANG},
+    {KEY_SETTING_CPU, KA_MODE, SM_CPU_POLICY},
+    {KEY_SETTING_BURST_K, KA_MODE, SM_BURST_K},
+    {KEY_SETTING_BURST_GAP, KA_MODE, SM_BURST_GAP},
+    {KEY_HISTORY, KA_MODE, SM_HISTORY},
+    {KEY_EXPORT, KA_EXPORT, 0},
+    {KEY_UP, KA_VALUE, KN_UP},
+    {KEY_DOWN, KA_VALUE, KN_DOWN},
+    {KEY_LEFT, KA_VALUE, KN_LEFT},
+    {KEY_RIGHT, KA_VALUE, KN_RIGHT},
+};
+
 static uint8_t BRIGHT_LVL;       // 0 - 255 : LCD bright level
 static uint8_t LOWBAT_THRESHOLD; // 5 - 95% : LOW BATTERY Threshold level
 const char *NVM_BRIGHT = "brt";
 const char *NVM_LOWBAT = "lbat";
 const char *NVM_LANG = "lang";
-const char *LANG[] = {"English", "日本語"};
+const char *NVM_CPU = "cpug";
+static uint8_t CPU_POLICY = CPU_LOW;
+const char *NVM_BURST_K = "bk";
+const char *NVM_BURST_GAP = "bgap";
+static uint8_t BURST_K;      // 1 - 16 : pings per displayed value
+static uint8_t BURST_GAP_MS; // 10 - 250 ms : gap between pings of a burst
 static uint8_t LANG_INDEX = 0;
-const char *meas_items[] = {"Distance", "距離"};
 
 void setup();
 void loop();
 void SR04_sensor();
+void burstFinish();
+bool burstReduce(double &distance, double &spread, uint64_t &ts);
 void dispInit();
-bool keyCheck();
-void settings();
+const KeyBinding *findKeyBinding(char key);
+void settings(const KeyEvent &ev);
 void changeSettings(SettingMode mode, KeyNum keyNo);
 void changeLang(KeyNum keyNo);
 bool updateLang(KeyNum keyNo);
+const char *msgText(MsgId id);
 void dispBatItem();
 void dispMeasItem();
 bool updateSettingValue(uint8_t &value, KeyNum keyNo, uint8_t min, uint8_t max, uint8_t step, uint8_t big_step);
@@ -110,17 +193,44 @@ void prtSetting(const char *msg, uint8_t data);
 void prtSetting(const char *msg, const char *data);
 void changeBright(KeyNum keyNo);
 void changeLowBatThr(KeyNum keyNo);
+void changeCpuPolicy(KeyNum keyNo);
+void changeBurstK(KeyNum keyNo);
+void changeBurstGap(KeyNum keyNo);
+void prtBurst(const char *msg, uint8_t data);
 void settingsInit();
 void prtDistance(double temp_val);
+void motionReset();
+void motionRebase(uint64_t new_base_us);
+void motionAdd(uint64_t ts_us, double distance);
+double motionVelocity();
+void prtVelocity(double velocity);
+void prtSpread(double spread);
 void batteryState();
 void prtBatLvl(uint8_t batLvl);
+void prtHealth();
+void sensorPinsBegin();
+void sensorRecover(HealthAction action);
+bool sensorPowerService();
 void lowBatteryCheck(uint8_t batLvl);
+void changeHistory(KeyNum keyNo);
+void dispHistory(RrdTier tier);
+void historyRefresh();
+void dispRestore();
+#ifdef BENCH
+void runBench();
+#endif
 
 // --------------------------------------------------------
 // --- For non-blocking HC-SR04 reading ---
-volatile unsigned long echoStartTime = 0;
-volatile unsigned long echoEndTime = 0;
+// 64-bit timestamps [us] are not atomic on the 32-bit core : echo_isr() and
+// the readers share echoMux (noInterrupts() is a no-op on arduino-esp32)
+static portMUX_TYPE echoMux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint64_t echoStartTime = 0;
+volatile uint64_t echoEndTime = 0;
+uint64_t triggerTime = 0; // nowUs() at the end of the trigger pulse
 volatile bool echoReceived = false;
+volatile uint8_t echoEdges = 0; // ISR edges since the last ping end
+bool echoHighAtTrigger = false;
 void IRAM_ATTR echo_isr();
 
 // --- HC-SR04 control Pin Assignment ----
@@ -130,51 +240,91 @@ constexpr uint8_t trigPin = 2; // Trigger Pin
 void setup()
 {
   m5stack_begin();
-
-  pinMode(echoPin, INPUT);
-  pinMode(trigPin, OUTPUT);
-  digitalWrite(trigPin, LOW);
-
-  // Attach interrupt to the echo pin
-  attachInterrupt(digitalPinToInterrupt(echoPin), echo_isr, CHANGE);
+  sensorPinsBegin();
+  healthBegin(SENSOR_POWER_SWITCH != 0);
 
   if (SD_ENABLE)
   { // M5stack-SD-Updater lobby
     SDU_lobby();
     SD.end();
   }
+  keyScanBegin(); // keyboard is scanned by its own task from here on
 
   settingsInit();
+  rrdBegin();
   dispInit();
   canvas.pushSprite(0, 0);
+
+#ifdef BENCH
+  runBench();
+  canvas.pushSprite(0, 0);
+#endif
 }
 
 void loop()
 {
   SR04_sensor();
   batteryState();
+  rrdService();
 
-  if (keyCheck())
-    settings();
+  KeyEvent ev;
+  while (getKeyEvent(ev))
+  {
+    CpuBoostScope boost; // settings redraw at full clock
+    settings(ev);
+  }
 
   vTaskDelay(1);
 }
 
 #define DIST_LINE_INDEX 3
 #define DIST_DISP_WIDTH 27
-static unsigned long prev_sr04_trigger_ms = 0L;
+static uint64_t prev_sr04_trigger_ms = 0;
+static uint64_t prev_burst_start_ms = 0;
+static uint64_t prev_ping_end_ms = 0;
 static bool sr04_triggered = false; // Flag to indicate a trigger pulse was sent
 
+// --- Recovery power cycle of the Grove 5V : stepped by SR04_sensor(), no ping until on ---
+enum SensorPower : uint8_t
+{
+  SP_ON,
+  SP_OFF,    // switched off, waiting POWER_CYCLE_OFF_MS
+  SP_SETTLE, // switched on, waiting POWER_CYCLE_SETTLE_MS
+};
+static SensorPower sensorPower = SP_ON;
+static uint64_t sensorPowerMs = 0; // start of the current phase
+
+// --- Burst oversampling : one displayed value from BURST_K pings ---
+static uint8_t burstDone = 0;  // pings finished in the current burst
+static uint8_t burstValid = 0; // valid echoes in the current burst
+static float burstDist[AppConfig::Burst::K_MAX];  // [cm]
+static uint64_t burstTs[AppConfig::Burst::K_MAX]; // [us] reflection time
+static uint64_t prev_burst_end_ms = 0;
+static float burstRateHz = NAN; // effective update rate
+
 void SR04_sensor()
 {
-  unsigned long current_ms = millis();
   bool needs_update = false;
+  PingResult result = PING_TIMEOUT;
+
+  if (!sensorPowerService())
+    return;
 
-  // Trigger the sensor at regular intervals if not waiting for an echo
-  if (!sr04_triggered && (current_ms - prev_sr04_trigger_ms >= AppConfig::Sensor::SR04_CHECK_INTERVAL_MS))
+  // Trigger the sensor if not waiting for an echo : the first ping of a burst
+  // at regular intervals, the following ones BURST_GAP_MS after the previous ping
+  // and at least MIN_CYCLE_MS after its trigger
+  if (!sr04_triggered)
   {
-    prev_sr04_trigger_ms = current_ms;
+    bool due = (burstDone == 0) ? elapsedMs(prev_burst_start_ms, AppConfig::Sensor::SR04_CHECK_INTERVAL_MS)
+                                : elapsedMs(prev_ping_end_ms, BURST_GAP_MS) && elapsedMs(prev_sr04_trigger_ms, AppConfig::Sensor::MIN_CYCLE_MS);
+    if (!due)
+      return;
+    if (burstDone == 0)
+      prev_burst_start_ms = nowMs();
+
+    prev_sr04_trigger_ms = nowMs();
     echoReceived = false;
+    echoHighAtTrigger = (digitalRead(echoPin) == HIGH);
     sr04_triggered = true; // Set flag that we are waiting for an echo
 
     // Send trigger pulse
@@ -183,16 +333,20 @@ void SR04_sensor()
     digitalWrite(trigPin, HIGH);
     delayMicroseconds(10);
     digitalWrite(trigPin, LOW);
+    triggerTime = nowUs();
+    return;
   }
 
   // Check if a new echo has been received
   if (echoReceived)
   {
-    // Disable interrupts temporarily to safely read volatile variables
-    noInterrupts();
-    unsigned long duration = echoEndTime - echoStartTime;
+    // Read each volatile once, in a critical section shared with the ISR
+    portENTER_CRITICAL(&echoMux);
+    uint64_t startTime = echoStartTime;
+    uint64_t endTime = echoEndTime;
     echoReceived = false; // Reset the flag
-    interrupts();
+    portEXIT_CRITICAL(&echoMux);
+    uint64_t duration = endTime - startTime;
 
     // Check for valid duration (e.g., less than 38ms for ~6.5m range)
     if (duration > 0 && duration < AppConfig::Sensor::MAX_ECHO_DURATION_US)
@@ -200,45 +354,214 @@ void SR04_sensor()
       // Speed of sound in cm/us (at approx. 20°C)
       const double soundVelocity = 34350.0 / 1000000.0;
       double distance = duration * soundVelocity / 2; // [cm]
-      prtDistance(distance);
-      dbPrtln("Distance = " + String(distance) + " cm");
+
+      // The reflection happens half-way through the echo pulse.
+      burstDist[burstValid] = distance;
+      burstTs[burstValid] = startTime + duration / 2;
+      burstValid++;
+      result = PING_OK;
+      dbPrtln("ping = " + String(distance) + " cm, trig-echo = " + String((unsigned long)(startTime - triggerTime)) + " us");
     }
     else
     {
-      // Duration too long or zero, likely an error or out of range
-      prtDistance(NAN);
-      dbPrtln("Distance = NAN");
+      // Duration too long or zero, likely an error or out of range : rejected
+      result = PING_RANGE;
+      dbPrtln("ping = NAN");
     }
     needs_update = true;
   }
   // Check for timeout (e.g., 60ms is a reasonable timeout for HC-SR04)
-  else if (sr04_triggered && (current_ms - prev_sr04_trigger_ms > AppConfig::Sensor::SENSOR_TIMEOUT_MS))
+  else if (elapsedMs(prev_sr04_trigger_ms, AppConfig::Sensor::SENSOR_TIMEOUT_MS + 1))
   {
-    prtDistance(NAN); // Report timeout as Not-A-Number
-    needs_update = true;
+    needs_update = true; // Report timeout as a rejected ping
   }
 
   if (needs_update)
   {
+    // a valid or out-of-range echo is one rising and one falling edge,
+    // a timeout none : anything else is spurious
+    portENTER_CRITICAL(&echoMux);
+    uint8_t edges = echoEdges;
+    echoEdges = 0;
+    portEXIT_CRITICAL(&echoMux);
+    uint8_t expected = (result == PING_TIMEOUT) ? 0 : 2;
+    uint8_t spurious = (edges > expected) ? edges - expected : 0;
+    bool echoHigh = echoHighAtTrigger && digitalRead(echoPin) == HIGH;
+
+    HealthAction action = healthPing(result, spurious, echoHigh);
+    if (action != HA_NONE)
+      sensorRecover(action);
+
     sr04_triggered = false;
-    canvas.pushSprite(0, 0);
+    prev_ping_end_ms = nowMs();
+    if (++burstDone >= BURST_K)
+      burstFinish();
+  }
+}
+
+void sensorPinsBegin()
+{
+  pinMode(echoPin, INPUT);
+  pinMode(trigPin, OUTPUT);
+  digitalWrite(trigPin, LOW);
+
+  // Attach interrupt to the echo pin
+  attachInterrupt(digitalPinToInterrupt(echoPin), echo_isr, CHANGE);
+}
+
+void sensorRecover(HealthAction action)
+{
+  dbPrtln("sensor recovery : " + String(action == HA_REINIT ? "re-init pins" : "power cycle"));
+  detachInterrupt(digitalPinToInterrupt(echoPin));
+
+  if (action == HA_POWER_CYCLE)
+  {
+    // Grove 5V off : sensorPowerService() switches it on again and
+    // re-initialises the pins, the loop keeps running meanwhile
+    digitalWrite(trigPin, LOW); // do not feed the sensor through the trigger pin
+    M5Cardputer.Power.setExtOutput(false);
+    sensorPower = SP_OFF;
+    sensorPowerMs = nowMs();
+    return;
+  }
+
+  sensorPinsBegin();
+  portENTER_CRITICAL(&echoMux);
+  echoReceived = false;
+  echoEdges = 0;
+  portEXIT_CRITICAL(&echoMux);
+}
+
+// true when the sensor is powered and settled
+bool sensorPowerService()
+{
+  switch (sensorPower)
+  {
+  case SP_OFF:
+    if (elapsedMs(sensorPowerMs, AppConfig::Sensor::POWER_CYCLE_OFF_MS))
+    {
+      M5Cardputer.Power.setExtOutput(true);
+      sensorPower = SP_SETTLE;
+      sensorPowerMs = nowMs();
+    }
+    return false;
+  case SP_SETTLE:
+    if (!elapsedMs(sensorPowerMs, AppConfig::Sensor::POWER_CYCLE_SETTLE_MS))
+      return false;
+    sensorPinsBegin();
+    portENTER_CRITICAL(&echoMux);
+    echoReceived = false;
+    echoEdges = 0;
+    portEXIT_CRITICAL(&echoMux);
+    sensorPower = SP_ON;
+    return true;
+  default:
+    return true;
+  }
+}
+
+void burstFinish()
+{
+  CpuBoostScope boost; // render and push at full clock
+
+  double distance = NAN, spread = NAN;
+  uint64_t ts = 0;
+  if (burstReduce(distance, spread, ts))
+  {
+    rrdAdd(distance);
+    motionAdd(ts, distance);
+  }
+  double velocity = isnan(distance) ? NAN : motionVelocity(); // no rate without a distance
+  prtDistance(distance);
+  prtSpread(spread);
+  prtVelocity(velocity);
+  prtHealth();
+
+  // effective update rate (smoothed)
+  uint64_t now = nowMs();
+  if (prev_burst_end_ms != 0 && now > prev_burst_end_ms)
+  {
+    float rate = 1000.0f / (now - prev_burst_end_ms);
+    burstRateHz = isnan(burstRateHz) ? rate : burstRateHz + AppConfig::Burst::RATE_SMOOTHING * (rate - burstRateHz);
   }
+  prev_burst_end_ms = now;
+  dbPrtln("Distance = " + String(distance) + " +- " + String(spread) + " cm (" + String(burstValid) + "/" + String(burstDone) + " pings), Velocity = " + String(velocity) + " cm/s, rate = " + String(burstRateHz) + " Hz");
+
+  burstDone = 0;
+  burstValid = 0;
+  if (settingMode == SM_HISTORY)
+    historyRefresh(); // the store has a new sample
+  canvas.pushSprite(0, 0);
+  cpuGovSample();
+}
+
+bool burstReduce(double &distance, double &spread, uint64_t &ts)
+{
+  // Robust average of the valid pings : drop the ones further than
+  // OUTLIER_MADS x MAD from the median, then mean / standard deviation.
+  const uint8_t n = burstValid;
+  if (n == 0)
+    return false;
+
+  float sorted[AppConfig::Burst::K_MAX];
+  float dev[AppConfig::Burst::K_MAX];
+  std::copy(burstDist, burstDist + n, sorted);
+  std::sort(sorted, sorted + n);
+  const float median = (n & 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  for (uint8_t i = 0; i < n; ++i)
+    dev[i] = fabsf(burstDist[i] - median);
+  std::sort(dev, dev + n);
+  const float mad = (n & 1) ? dev[n / 2] : (dev[n / 2 - 1] + dev[n / 2]) / 2;
+  const float limit = max(AppConfig::Burst::OUTLIER_MADS * 1.4826f * mad, AppConfig::Burst::OUTLIER_MIN_CM);
+
+  // at least half of the pings are within MAD of the median : kept >= 1
+  double sum = 0.0;
+  uint64_t tsOffset = 0; // relative to the first ping
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < n; ++i)
+  {
+    if (fabsf(burstDist[i] - median) > limit)
+      continue;
+    sum += burstDist[i];
+    tsOffset += burstTs[i] - burstTs[0];
+    kept++;
+  }
+  distance = sum / kept;
+  ts = burstTs[0] + tsOffset / kept;
+
+  if (kept > 1)
+  {
+    double sq = 0.0;
+    for (uint8_t i = 0; i < n; ++i)
+    {
+      if (fabsf(burstDist[i] - median) <= limit)
+        sq += (burstDist[i] - distance) * (burstDist[i] - distance);
+    }
+    spread = sqrt(sq / (kept - 1));
+  }
+  return true;
 }
 
 void IRAM_ATTR echo_isr()
 {
-  if (digitalRead(echoPin) == HIGH)
+  const uint64_t now = nowUs();
+  const bool high = (digitalRead(echoPin) == HIGH);
+  portENTER_CRITICAL_ISR(&echoMux);
+  if (echoEdges < UINT8_MAX)
+    echoEdges++;
+  if (high)
   {
-    echoStartTime = micros();
+    echoStartTime = now;
   }
   else
   {
-    echoEndTime = micros();
+    echoEndTime = now;
     echoReceived = true;
   }
+  portEXIT_CRITICAL_ISR(&echoMux);
 }
 
-static float PREV_DISTANCE = 0.0;
+static float PREV_DISTANCE = -1.0f; // impossible value : nothing measured yet
 void prtDistance(double temp_val)
 {
   // Skip redrawing if the value hasn't changed.
@@ -248,6 +571,8 @@ void prtDistance(double temp_val)
     return;
   }
   PREV_DISTANCE = temp_val;
+  if (settingMode == SM_HISTORY)
+    return; // drawn by dispRestore()
 
   char buf[10];
   if (isnan(temp_val))
@@ -259,32 +584,177 @@ void prtDistance(double temp_val)
     snprintf(buf, sizeof(buf), "%3.1f", temp_val);
   }
 
-  canvas.setTextColor(TFT_WHITE, TFT_BLACK);
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
   canvas.setFont(&fonts::Font7);
   canvas.setTextSize(1);
-  canvas.fillRect(0, SC_LINES[DIST_LINE_INDEX], X_WIDTH, AppConfig::Layout::DISTANCE_FONT_SIZE, TFT_BLACK);
+  canvas.fillRect(0, SC_LINES[DIST_LINE_INDEX], X_WIDTH, AppConfig::Layout::DISTANCE_FONT_SIZE, uiColor(UC_BLACK));
   canvas.drawCenterString(buf, X_WIDTH / 2, SC_LINES[DIST_LINE_INDEX]);
 }
 
+// --------------------------------------------------------
+// --- Motion estimator ---
+// Least-squares slope of distance over the echo timestamps of the
+// last Motion::WINDOW valid samples. Running sums keep it O(1) per sample.
+struct MotionSample
+{
+  double t; // [s] since motionBaseUs
+  double d; // [cm]
+};
+static MotionSample motionBuf[AppConfig::Motion::WINDOW];
+static uint8_t motionHead = 0;  // next write position
+static uint8_t motionCount = 0; // valid samples in motionBuf
+static uint64_t motionBaseUs = 0;
+static uint64_t motionLastUs = 0;
+static double sumT = 0.0, sumD = 0.0, sumTT = 0.0, sumTD = 0.0;
+
+void motionReset()
+{
+  motionHead = 0;
+  motionCount = 0;
+  sumT = sumD = sumTT = sumTD = 0.0;
+}
+
+void motionRebase(uint64_t new_base_us)
+{
+  // Shift every stored sample to the new time origin and rebuild the sums.
+  // Runs once per REBASE_US, so the cost per sample stays constant.
+  const double shift = (new_base_us - motionBaseUs) * 1e-6;
+  motionBaseUs = new_base_us;
+  sumT = sumD = sumTT = sumTD = 0.0;
+
+  // While filling, the valid samples are [0, motionCount); once full, all are valid.
+  for (uint8_t i = 0; i < motionCount; ++i)
+  {
+    MotionSample &s = motionBuf[i];
+    s.t -= shift;
+    sumT += s.t;
+    sumD += s.d;
+    sumTT += s.t * s.t;
+    sumTD += s.t * s.d;
+  }
+}
+
+void motionAdd(uint64_t ts_us, double distance)
+{
+  if (motionCount > 0 && ts_us - motionLastUs > AppConfig::Motion::MAX_GAP_US)
+    motionReset(); // too old to fit together with the new sample
+
+  if (motionCount == 0)
+    motionBaseUs = ts_us;
+  else if (ts_us - motionBaseUs > AppConfig::Motion::REBASE_US)
+    motionRebase(ts_us);
+  motionLastUs = ts_us;
+
+  MotionSample &s = motionBuf[motionHead];
+  if (motionCount == AppConfig::Motion::WINDOW)
+  { // drop the oldest sample, which is the one being overwritten
+    sumT -= s.t;
+    sumD -= s.d;
+    sumTT -= s.t * s.t;
+    sumTD -= s.t * s.d;
+  }
+  else
+  {
+    motionCount++;
+  }
+
+  s.t = (ts_us - motionBaseUs) * 1e-6;
+  s.d = distance;
+  sumT += s.t;
+  sumD += s.d;
+  sumTT += s.t * s.t;
+  sumTD += s.t * s.d;
+  motionHead = (motionHead + 1) % AppConfig::Motion::WINDOW;
+}
+
+double motionVelocity()
+{
+  // [cm/s] : positive = receding, negative = approaching
+  if (motionCount > 0 && nowUs() - motionLastUs > AppConfig::Motion::MAX_GAP_US)
+    motionReset(); // no valid sample for too long : the fit is stale
+  if (motionCount < AppConfig::Motion::MIN_SAMPLES)
+    return NAN;
+
+  const double n = motionCount;
+  const double den = n * sumTT - sumT * sumT;
+  if (den <= 1e-9)
+    return NAN;
+  return (n * sumTD - sumT * sumD) / den;
+}
+
+#define VELO_LINE_INDEX 2
+static float PREV_VELOCITY = INFINITY; // impossible value : nothing measured yet
+void prtVelocity(double velocity)
+{
+  // Line2 : approach(-) / recede(+) rate
+  if (PREV_VELOCITY == velocity || (isnan(PREV_VELOCITY) && isnan(velocity)))
+  {
+    return;
+  }
+  PREV_VELOCITY = velocity;
+  if (settingMode == SM_HISTORY)
+    return; // drawn by dispRestore()
+
+  char buf[16];
+  if (isnan(velocity))
+  {
+    snprintf(buf, sizeof(buf), "--- cm/s");
+  }
+  else
+  {
+    snprintf(buf, sizeof(buf), "%+.1f cm/s", velocity);
+  }
+
+  canvas.setTextColor(uiColor(UC_SKYBLUE), uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_G16);
+  canvas.setTextSize(1);
+  canvas.fillRect(0, SC_LINES[VELO_LINE_INDEX], X_WIDTH, H_CHR, uiColor(UC_BLACK));
+  canvas.drawCenterString(buf, X_WIDTH / 2, SC_LINES[VELO_LINE_INDEX]);
+}
+
+static float PREV_SPREAD = NAN;
+void prtSpread(double spread)
+{
+  // Line7 : burst spread, next to the unit
+  if (PREV_SPREAD == spread || (isnan(PREV_SPREAD) && isnan(spread)))
+  {
+    return;
+  }
+  PREV_SPREAD = spread;
+  if (settingMode == SM_HISTORY)
+    return; // drawn by dispRestore()
+
+  canvas.fillRect(W_CHR * AppConfig::Layout::SPREAD_POS, SC_LINES[7], W_CHR * AppConfig::Layout::SPREAD_LEN, H_CHR + 4, uiColor(UC_BLACK));
+  if (isnan(spread))
+    return; // single ping : no spread
+
+  char buf[12];
+  snprintf(buf, sizeof(buf), "%s%.1f", msgText(MSG_PLUS_MINUS), spread);
+  canvas.setTextColor(uiColor(UC_GREEN), uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_G16);
+  canvas.setTextSize(1);
+  canvas.drawString(buf, W_CHR * AppConfig::Layout::SPREAD_POS, SC_LINES[7] + 4);
+}
+
 void dispInit()
 {
   // ---012345678901234567890123456789----
-  // L0:- HC-SR04 Sensor -    bat.---%
+  // L0:HC-SR04 T0 R0 S0    ● bat.---%
   // L1: (settings display line)
-  // L2:
+  // L2:          +0.0 cm/s
   // L3:
   // L4:
   // L5:
   // L6:
-  // L7:  Distance                cm
+  // L7:  Distance      ±x.x      cm
   // ---012345678901234567890123456789----
 
-  canvas.fillScreen(TFT_BLACK); // all clear
-  canvas.setFont(&fonts::lgfxJapanGothic_16);
+  canvas.fillScreen(uiColor(UC_BLACK)); // all clear
+  canvas.setFont(L10N_FONT_G16);
 
   //--L0 : title--------------
-  canvas.setTextColor(TFT_SKYBLUE, TFT_BLACK);
-  canvas.drawString(F("- HC-SR04 Sensor -"), 0, SC_LINES[0]);
+  canvas.setTextColor(uiColor(UC_SKYBLUE), uiColor(UC_BLACK));
+  canvas.drawString(F("HC-SR04"), 0, SC_LINES[0]);
 
   // L0 :Battery Level -----
   dispBatItem();
@@ -292,84 +762,60 @@ void dispInit()
   canvas.drawString(F("%"), W_CHR * AppConfig::Layout::BATLVL_PERCENT_POS, SC_LINES[0]);
 
   // L7 : Measuremnt items
-  canvas.setTextColor(TFT_GREEN, TFT_BLACK);
+  canvas.setTextColor(uiColor(UC_GREEN), uiColor(UC_BLACK));
   canvas.drawString(F("cm"), W_CHR * AppConfig::Layout::MEAS_UNIT_POS, SC_LINES[7], &fonts::Font4);
   dispMeasItem();
 }
 
-bool keyCheck()
+const KeyBinding *findKeyBinding(char key)
 {
-  M5Cardputer.update(); // update Cardputer key input
-
-  if (M5Cardputer.Keyboard.isChange())
+  for (const KeyBinding &b : KEY_BINDINGS)
   {
-    if (M5Cardputer.Keyboard.isPressed())
-      return true;
+    if (b.key == key)
+      return &b;
   }
-  return false;
+  return nullptr;
 }
 
-void settings()
+void settings(const KeyEvent &ev)
 {
-  // Part 1: Handle setting mode changes.
-  // These keys change the current setting mode.
-  if (M5Cardputer.Keyboard.isKeyPressed(KEY_SETTING_ESCAPE))
-  {
-    if (settingMode == SM_ESC)
-      return;
-    settingMode = SM_ESC;
-  }
-  else if (M5Cardputer.Keyboard.isKeyPressed(KEY_SETTING_BRIGHTNESS))
-  {
-    if (settingMode == SM_BRIGHT_LEVEL)
-      return;
-    settingMode = SM_BRIGHT_LEVEL;
-  }
-  else if (M5Cardputer.Keyboard.isKeyPressed(KEY_SETTING_LOWBAT))
-  {
-    if (settingMode == SM_LOWBAT_THRESHOLD)
-      return;
-    settingMode = SM_LOWBAT_THRESHOLD;
-  }
-  else if (M5Cardputer.Keyboard.isKeyPressed(KEY_SETTING_LANG))
+  const KeyBinding *binding = findKeyBinding(ev.key);
+  if (binding == nullptr || ev.type == KE_RELEASE)
+    return; // No relevant key pressed for mode change or value adjustment.
+
+  switch (binding->action)
   {
-    if (settingMode == SM_LANG)
+  case KA_MODE:
+    // Mode keys change the current setting mode (press only).
+    if (ev.type != KE_PRESS || settingMode == (SettingMode)binding->arg)
       return;
-    settingMode = SM_LANG;
-  }
-  else
-  {
-    // Part 2: Handle value adjustments for the current mode.
-    // These keys adjust the value of the selected setting.
-    KeyNum keyNum = KN_NONE;
-
-    if (M5Cardputer.Keyboard.isKeyPressed(KEY_UP))
-    {
-      keyNum = KN_UP;
-    }
-    else if (M5Cardputer.Keyboard.isKeyPressed(KEY_DOWN))
-    {
-      keyNum = KN_DOWN;
-    }
-    else if (M5Cardputer.Keyboard.isKeyPressed(KEY_LEFT))
+    if (settingMode == SM_HISTORY)
     {
-      keyNum = KN_LEFT;
+      settingMode = (SettingMode)binding->arg;
+      dispRestore(); // leave the full-screen history view
     }
-    else if (M5Cardputer.Keyboard.isKeyPressed(KEY_RIGHT))
+    else
     {
-      keyNum = KN_RIGHT;
+      settingMode = (SettingMode)binding->arg;
     }
-    else
+    // Display the initial state for the new mode.
+    changeSettings(settingMode, KN_NONE);
+    break;
+  case KA_VALUE:
+    // Value keys adjust the selected setting (press and auto-repeat).
+    changeSettings(settingMode, (KeyNum)binding->arg);
+    break;
+  case KA_EXPORT:
+    if (ev.type != KE_PRESS)
+      return;
+    rrdExport(Serial);
+    if (settingMode != SM_HISTORY)
     {
-      return; // No relevant key pressed for mode change or value adjustment.
+      prtSetting("export -> ", "Serial");
+      canvas.pushSprite(0, 0);
     }
-    changeSettings(settingMode, keyNum);
-    return; // Exit after handling value adjustment.
+    break;
   }
-
-  // This part is reached only when the mode has been changed (Part 1).
-  // It displays the initial state for the new mode.
-  changeSettings(settingMode, KN_NONE);
 }
 
 void changeSettings(SettingMode mode, KeyNum keyNo)
@@ -377,7 +823,7 @@ void changeSettings(SettingMode mode, KeyNum keyNo)
   switch (mode)
   {
   case SM_ESC:
-    canvas.fillRect(0, SC_LINES[1], X_WIDTH, H_CHR, TFT_BLACK);
+    canvas.fillRect(0, SC_LINES[1], X_WIDTH, H_CHR, uiColor(UC_BLACK));
     break;
   case SM_BRIGHT_LEVEL:
     changeBright(keyNo);
@@ -388,6 +834,18 @@ void changeSettings(SettingMode mode, KeyNum keyNo)
   case SM_LANG:
     changeLang(keyNo);
     break;
+  case SM_CPU_POLICY:
+    changeCpuPolicy(keyNo);
+    break;
+  case SM_BURST_K:
+    changeBurstK(keyNo);
+    break;
+  case SM_BURST_GAP:
+    changeBurstGap(keyNo);
+    break;
+  case SM_HISTORY:
+    changeHistory(keyNo);
+    break;
   default:
     return;
   }
@@ -402,7 +860,7 @@ void changeLang(KeyNum keyNo)
     dispMeasItem();
     dispBatItem();
   }
-  prtSetting("lang = ", LANG[LANG_INDEX]);
+  prtSetting("lang = ", msgText(MSG_LANG_NAME));
 }
 
 bool updateLang(KeyNum keyNo)
@@ -423,24 +881,42 @@ bool updateLang(KeyNum keyNo)
 
 void dispBatItem()
 {
-  canvas.fillRect(W_CHR * AppConfig::Layout::BATLVL_ITEM_POS, SC_LINES[0], W_CHR * AppConfig::Layout::BATLVL_ITEM_LEN, H_CHR, TFT_BLACK);
-  canvas.setFont(&fonts::lgfxJapanMincho_16);
-  canvas.setTextColor(TFT_WHITE, TFT_BLACK);
-  canvas.drawString(BATLVL_TITLE[LANG_INDEX], W_CHR * AppConfig::Layout::BATLVL_ITEM_POS, SC_LINES[0]);
+  canvas.fillRect(W_CHR * AppConfig::Layout::BATLVL_ITEM_POS, SC_LINES[0], W_CHR * AppConfig::Layout::BATLVL_ITEM_LEN, H_CHR, uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_M16);
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
+  canvas.drawString(msgText(MSG_BAT), W_CHR * AppConfig::Layout::BATLVL_ITEM_POS, SC_LINES[0]);
 }
 
 void dispMeasItem()
 {
-  canvas.setFont(&fonts::lgfxJapanGothic_24);
+  canvas.setFont(L10N_FONT_G24);
   canvas.setTextSize(1);
-  int width = max(canvas.textWidth(meas_items[0]), canvas.textWidth(meas_items[1]));
+
+  // widest item of all languages : precomputed at build time,
+  // measured once here if the font subset was not generated
+  static int width = -1;
+  if (width < 0)
+  {
+    for (uint8_t lang = 0; lang < LANG_NUM; ++lang)
+    {
+      int w = L10N_WIDTH_G24[lang][MSG_DISTANCE];
+      if (w < 0)
+        w = canvas.textWidth(MSG_TABLE[lang][MSG_DISTANCE]);
+      width = max(width, w);
+    }
+  }
 
   // clear
-  canvas.fillRect(0, SC_LINES[7], W_CHR * AppConfig::Layout::MEAS_ITEM_POS + width, AppConfig::Layout::MEAS_ITEM_FONT_SIZE, TFT_BLACK);
+  canvas.fillRect(0, SC_LINES[7], W_CHR * AppConfig::Layout::MEAS_ITEM_POS + width, AppConfig::Layout::MEAS_ITEM_FONT_SIZE, uiColor(UC_BLACK));
 
   // measuremt items
-  canvas.setTextColor(TFT_ORANGE, TFT_BLACK);
-  canvas.drawString(meas_items[LANG_INDEX], W_CHR * AppConfig::Layout::MEAS_ITEM_POS, SC_LINES[7]);
+  canvas.setTextColor(uiColor(UC_ORANGE), uiColor(UC_BLACK));
+  canvas.drawString(msgText(MSG_DISTANCE), W_CHR * AppConfig::Layout::MEAS_ITEM_POS, SC_LINES[7]);
+}
+
+const char *msgText(MsgId id)
+{
+  return MSG_TABLE[LANG_INDEX][id];
 }
 
 bool updateSettingValue(uint8_t &value, KeyNum keyNo, uint8_t min, uint8_t max, uint8_t step, uint8_t big_step)
@@ -493,10 +969,10 @@ void prtSetting(const char *msg, const char *data)
   snprintf(msgBuf, sizeof(msgBuf), "%s%s", msg, data);
   dbPrtln(msgBuf);
 
-  canvas.setTextColor(TFT_WHITE, TFT_BLACK);
-  canvas.setFont(&fonts::lgfxJapanGothic_12);
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_G12);
   canvas.setTextSize(1);
-  canvas.fillRect(0, SC_LINES[1], X_WIDTH, H_CHR, TFT_BLACK); // clear L1
+  canvas.fillRect(0, SC_LINES[1], X_WIDTH, H_CHR, uiColor(UC_BLACK)); // clear L1
   canvas.drawString(msgBuf, W_CHR * AppConfig::Layout::SETTING_DISP_POS, SC_LINES[1]);
 }
 
@@ -523,26 +999,128 @@ void changeLowBatThr(KeyNum keyNo)
   prtSetting("lowBattery threshold = ", LOWBAT_THRESHOLD);
 }
 
+void changeCpuPolicy(KeyNum keyNo)
+{
+  const uint8_t step = 1;
+  if (updateSettingValue(CPU_POLICY, keyNo, 0, CPU_POLICY_NUM - 1, step, step))
+  {
+    cpuSetPolicy(CPU_POLICY);
+    wrtNVS(NVM_CPU, CPU_POLICY);
+  }
+
+  // energy per sample under the current policy (CPU estimate)
+  char buf[24];
+  double energy = cpuEnergyPerSample();
+  if (isnan(energy))
+    snprintf(buf, sizeof(buf), "%s  --mJ/smp", CPU_POLICY_NAME[CPU_POLICY]);
+  else
+    snprintf(buf, sizeof(buf), "%s  %.1fmJ/smp", CPU_POLICY_NAME[CPU_POLICY], energy);
+  prtSetting("cpu = ", buf);
+}
+
+void changeBurstK(KeyNum keyNo)
+{
+  const uint8_t step_short = 1;
+  const uint8_t step_big = 4;
+  if (updateSettingValue(BURST_K, keyNo, AppConfig::Burst::K_MIN, AppConfig::Burst::K_MAX, step_short, step_big))
+  {
+    wrtNVS(NVM_BURST_K, BURST_K);
+  }
+  prtBurst("burst K = ", BURST_K);
+}
+
+void changeBurstGap(KeyNum keyNo)
+{
+  const uint8_t step_short = 5;
+  const uint8_t step_big = 50;
+  if (updateSettingValue(BURST_GAP_MS, keyNo, AppConfig::Burst::GAP_MS_MIN, AppConfig::Burst::GAP_MS_MAX, step_short, step_big))
+  {
+    wrtNVS(NVM_BURST_GAP, BURST_GAP_MS);
+  }
+  prtBurst("burst gap ms = ", BURST_GAP_MS);
+}
+
+void prtBurst(const char *msg, uint8_t data)
+{
+  // setting value with the effective update rate
+  char buf[16];
+  if (isnan(burstRateHz))
+    snprintf(buf, sizeof(buf), "%3u  --Hz", data);
+  else
+    snprintf(buf, sizeof(buf), "%3u  %.2fHz", data, burstRateHz);
+  prtSetting(msg, buf);
+}
+
 void settingsInit()
 {
   loadSetting(NVM_BRIGHT, BRIGHT_LVL, AppConfig::BRIGHT_LVL_INIT, AppConfig::BRIGHT_LVL_MIN, AppConfig::BRIGHT_LVL_MAX);
   M5Cardputer.Display.setBrightness(BRIGHT_LVL);
   loadSetting(NVM_LOWBAT, LOWBAT_THRESHOLD, AppConfig::LOWBAT_THRESHOLD_INIT, AppConfig::LOWBAT_THRESHOLD_MIN, AppConfig::LOWBAT_THRESHOLD_MAX);
   loadSetting(NVM_LANG, LANG_INDEX, AppConfig::LANG_INIT, 0, AppConfig::LANG_MAX);
+  loadSetting(NVM_CPU, CPU_POLICY, CPU_LOW, 0, CPU_POLICY_NUM - 1);
+  loadSetting(NVM_BURST_K, BURST_K, AppConfig::Burst::K_INIT, AppConfig::Burst::K_MIN, AppConfig::Burst::K_MAX);
+  loadSetting(NVM_BURST_GAP, BURST_GAP_MS, AppConfig::Burst::GAP_MS_INIT, AppConfig::Burst::GAP_MS_MIN, AppConfig::Burst::GAP_MS_MAX);
+  cpuSetPolicy(CPU_POLICY);
 }
 
-static unsigned long PREV_BATCHK_TM = 0L;
+// fault counters and health indicator are redrawn when they change
+static uint32_t PREV_HEALTH_T = UINT32_MAX; // impossible value forces the first update
+static uint32_t PREV_HEALTH_R = UINT32_MAX;
+static uint32_t PREV_HEALTH_S = UINT32_MAX;
+static uint8_t PREV_HEALTH = SH_NUM;
+void prtHealth()
+{
+  // Line0 : sensor health
+  //---- 012345678901234567890123456789---
+  // L0_"        Txxx Rxxx Sxxx  ●      "--
+  //      T : timeouts, R : out of range, S : spurious edges (since boot)
+  //      ● : green ok, orange degraded, red stuck / dead
+  //          (2-bit canvas : orange = red, degraded is a ring)
+  const HealthStats &hs = healthStats();
+  const SensorHealth h = healthState();
+  if (hs.timeouts == PREV_HEALTH_T && hs.ranges == PREV_HEALTH_R && hs.spurious == PREV_HEALTH_S && h == PREV_HEALTH)
+    return;
+  PREV_HEALTH_T = hs.timeouts;
+  PREV_HEALTH_R = hs.ranges;
+  PREV_HEALTH_S = hs.spurious;
+  PREV_HEALTH = h;
+  if (settingMode == SM_HISTORY)
+    return; // drawn by dispRestore()
+
+  const uint32_t cmax = AppConfig::Layout::HEALTH_COUNT_MAX;
+  char msg[40]; // three full %lu values
+  snprintf(msg, sizeof(msg), "T%lu R%lu S%lu", (unsigned long)min(hs.timeouts, cmax), (unsigned long)min(hs.ranges, cmax), (unsigned long)min(hs.spurious, cmax));
+
+  canvas.fillRect(W_CHR * AppConfig::Layout::HEALTH_COUNT_POS, SC_LINES[0], W_CHR * AppConfig::Layout::HEALTH_COUNT_LEN, H_CHR, uiColor(UC_BLACK)); // clear
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_G12);
+  canvas.setTextSize(1);
+  canvas.drawString(msg, W_CHR * AppConfig::Layout::HEALTH_COUNT_POS, SC_LINES[0] + 2);
+
+  const UiColor dot = (h == SH_OK) ? UC_GREEN : (h == SH_DEGRADED) ? UC_ORANGE : UC_RED;
+  const int32_t dotX = W_CHR * AppConfig::Layout::HEALTH_DOT_POS + W_CHR;
+  const int32_t dotY = SC_LINES[0] + H_CHR / 2;
+  const int32_t dotR = H_CHR / 2 - 3;
+  if (h == SH_DEGRADED && CANVAS_COLOR_DEPTH == 2)
+  { // orange and red share a palette entry : hollow, so it differs from stuck / dead
+    canvas.fillCircle(dotX, dotY, dotR, uiColor(UC_BLACK));
+    canvas.drawCircle(dotX, dotY, dotR, uiColor(dot));
+    canvas.drawCircle(dotX, dotY, dotR - 1, uiColor(dot));
+  }
+  else
+    canvas.fillCircle(dotX, dotY, dotR, uiColor(dot));
+}
+
+static uint64_t PREV_BATCHK_TM = 0;
 static uint8_t PREV_BATLVL = 255; // Use an impossible value to force the first update
 static bool batCheck_first = true;
 void batteryState()
 {
-  unsigned long currentTime = millis(); // Get current time once
-
-  if (currentTime - PREV_BATCHK_TM < AppConfig::Battery::BATTERY_CHECK_INTERVAL_MS)
+  if (!elapsedMs(PREV_BATCHK_TM, AppConfig::Battery::BATTERY_CHECK_INTERVAL_MS))
     return;
 
   // This will update consecutiveLowBatteryCount
-  PREV_BATCHK_TM = currentTime;
+  PREV_BATCHK_TM = nowMs();
   uint8_t batLvl = (uint8_t)M5Cardputer.Power.getBatteryLevel(); // Get battery level
   dbPrtln("batLvl: " + String(batLvl));
   if (batLvl > AppConfig::BATLVL_MAX)
@@ -577,14 +1155,17 @@ void prtBatLvl(uint8_t batLvl)
   if (batLvl == PREV_BATLVL_DISP)
     return;
   PREV_BATLVL_DISP = batLvl;
+  if (settingMode == SM_HISTORY)
+    return; // drawn by dispRestore()
+  CpuBoostScope boost;
 
   char msg[4] = ""; // message buffer
   snprintf(msg, sizeof(msg), "%3u", batLvl);
   dbPrtln(msg);
 
-  canvas.fillRect(W_CHR * AppConfig::Layout::BATLVL_VALUE_POS, SC_LINES[0], W_CHR * AppConfig::Layout::BATLVL_VALUE_LEN, H_CHR, TFT_BLACK); // clear
-  canvas.setTextColor(TFT_WHITE, TFT_BLACK);
-  canvas.setFont(&fonts::lgfxJapanMincho_16);
+  canvas.fillRect(W_CHR * AppConfig::Layout::BATLVL_VALUE_POS, SC_LINES[0], W_CHR * AppConfig::Layout::BATLVL_VALUE_LEN, H_CHR, uiColor(UC_BLACK)); // clear
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_M16);
   canvas.setTextSize(1);
   canvas.drawString(msg, W_CHR * AppConfig::Layout::BATLVL_VALUE_POS, SC_LINES[0]);
   canvas.pushSprite(0, 0);
@@ -609,11 +1190,150 @@ void lowBatteryCheck(uint8_t batLvl)
 
   if (consecutiveLowBatteryCount >= AppConfig::Battery::LOWBAT_CONSECUTIVE_READINGS)
   {
-    canvas.fillScreen(TFT_BLACK);
-    canvas.setTextColor(TFT_RED, TFT_BLACK);
+    canvas.fillScreen(uiColor(UC_BLACK));
+    canvas.setTextColor(uiColor(UC_RED), uiColor(UC_BLACK));
     canvas.drawCenterString(F("Low Battery !!"), X_WIDTH / 2, SC_LINES[3], &fonts::Font4);
     canvas.pushSprite(0, 0);
+    rrdCheckpoint(); // keep the history across the power off
     POWER_OFF();
     // *** NEVER RETURN ***
   }
 }
+
+// --------------------------------------------------------
+// --- History screen (time-series store) ---
+static uint8_t HISTORY_TIER = RRD_MINUTE;
+void changeHistory(KeyNum keyNo)
+{
+  switch (keyNo)
+  {
+  case KN_UP:
+  case KN_RIGHT:
+    HISTORY_TIER = (HISTORY_TIER + 1) % RRD_TIER_NUM;
+    break;
+  case KN_DOWN:
+  case KN_LEFT:
+    HISTORY_TIER = (HISTORY_TIER + RRD_TIER_NUM - 1) % RRD_TIER_NUM;
+    break;
+  default:
+    break;
+  }
+  dispHistory((RrdTier)HISTORY_TIER);
+}
+
+void dispHistory(RrdTier tier)
+{
+  // ---012345678901234567890123456789----
+  // L0:History < 1 min >       n=61
+  // L1:xxx  |||
+  //  ~      min-max bars (sky blue) / mean (white)
+  // L6:xxx  |||||||||||||     newest at right
+  // L7:min xxx.x  avg xxx.x  max xxx.x  (newest)
+  // ---012345678901234567890123456789----
+  char buf[40];
+  const uint16_t n = rrdCount(tier);
+
+  canvas.fillScreen(uiColor(UC_BLACK));
+  canvas.setFont(L10N_FONT_G16);
+  canvas.setTextSize(1);
+  canvas.setTextColor(uiColor(UC_SKYBLUE), uiColor(UC_BLACK));
+  snprintf(buf, sizeof(buf), "History < %s >", RRD_TIER_NAME[tier]);
+  canvas.drawString(buf, 0, SC_LINES[0]);
+  snprintf(buf, sizeof(buf), "n=%u", n);
+  canvas.drawRightString(buf, X_WIDTH, SC_LINES[0]);
+
+  // graph area
+  const int gx = W_CHR * AppConfig::Layout::HISTORY_GRAPH_POS;
+  const int gy = SC_LINES[1] + 2;
+  const int gw = X_WIDTH - gx;
+  const int gh = SC_LINES[7] - gy - 2;
+  const int barW = constrain(gw / max<int>(n, 1), 1, AppConfig::Layout::HISTORY_BAR_MAX_W);
+  const uint16_t bars = min<int>(n, gw / barW);
+
+  // vertical scale over the buckets shown
+  float lo = 0.0f, hi = 0.0f;
+  bool any = false;
+  RrdBucket b;
+  for (uint16_t age = 0; age < bars && rrdGet(tier, age, b); ++age)
+  {
+    if (b.count == 0)
+      continue;
+    lo = any ? min(lo, b.min) : b.min;
+    hi = any ? max(hi, b.max) : b.max;
+    any = true;
+  }
+
+  canvas.setFont(L10N_FONT_G12);
+  canvas.setTextColor(uiColor(UC_WHITE), uiColor(UC_BLACK));
+  if (!any)
+  {
+    canvas.drawCenterString("no data", X_WIDTH / 2, SC_LINES[4]);
+    return;
+  }
+  if (hi - lo < 1.0f)
+  { // keep a flat line in the middle of the graph
+    lo -= 0.5f;
+    hi += 0.5f;
+  }
+
+  snprintf(buf, sizeof(buf), "%.0f", hi);
+  canvas.drawString(buf, 0, gy);
+  snprintf(buf, sizeof(buf), "%.0f", lo);
+  canvas.drawString(buf, 0, gy + gh - canvas.fontHeight());
+  canvas.drawFastVLine(gx - 2, gy, gh, uiColor(UC_GREEN));
+
+  for (uint16_t age = 0; age < bars && rrdGet(tier, age, b); ++age)
+  {
+    if (b.count == 0)
+      continue;
+    const int x = gx + gw - (age + 1) * barW;
+    const int yMax = gy + (int)((hi - b.max) * (gh - 1) / (hi - lo));
+    const int yMin = gy + (int)((hi - b.min) * (gh - 1) / (hi - lo));
+    const int yMean = gy + (int)((hi - b.sum / b.count) * (gh - 1) / (hi - lo));
+    const int w = max(1, barW - 1);
+    canvas.fillRect(x, yMax, w, yMin - yMax + 1, uiColor(UC_SKYBLUE));
+    canvas.drawFastHLine(x, yMean, w, uiColor(UC_WHITE));
+  }
+
+  // newest bucket
+  rrdGet(tier, 0, b);
+  if (b.count > 0)
+    snprintf(buf, sizeof(buf), "min %.1f  avg %.1f  max %.1f", b.min, b.sum / b.count, b.max);
+  else
+    snprintf(buf, sizeof(buf), "min ---  avg ---  max ---");
+  canvas.setTextColor(uiColor(UC_ORANGE), uiColor(UC_BLACK));
+  canvas.drawString(buf, 0, SC_LINES[7]);
+}
+
+void historyRefresh()
+{
+  dispHistory((RrdTier)HISTORY_TIER);
+}
+
+void dispRestore()
+{
+  // back from the history screen : main screen with the latest values.
+  // Values still at their initial impossible value were never measured
+  // and stay blank (prtXxx() skips them as unchanged).
+  dispInit();
+
+  float distance = PREV_DISTANCE;
+  PREV_DISTANCE = -1.0f; // impossible value forces the redraw
+  prtDistance(distance);
+
+  float velocity = PREV_VELOCITY;
+  PREV_VELOCITY = INFINITY; // impossible value forces the redraw
+  prtVelocity(velocity);
+
+  float spread = PREV_SPREAD;
+  PREV_SPREAD = -1.0f; // impossible value forces the redraw
+  prtSpread(spread);
+
+  PREV_HEALTH = SH_NUM; // impossible value forces the redraw
+  prtHealth();
+
+  uint8_t batLvl = PREV_BATLVL_DISP;
+  PREV_BATLVL_DISP = 255; // impossible value forces the redraw
+  if (batLvl != 255)
+    prtBatLvl(batLvl);
+}
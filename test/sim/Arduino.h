@@ -0,0 +1,172 @@
+// *******************************************************
+//  Host simulator : Arduino-ESP32 core subset
+// -------------------------------------------------------
+// Arduino.h
+//   only what src/ uses; time, pins and interrupts are
+//   driven by the simulator (sim.h)
+// *******************************************************
+#ifndef _SIM_ARDUINO_H
+#define _SIM_ARDUINO_H
+// -------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+#define IRAM_ATTR
+#define F(x) (x)
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define CHANGE 0x03
+#define ARDUINO_RUNNING_CORE 1
+
+typedef bool boolean;
+
+template <class T, class L, class H>
+T constrain(T x, L lo, H hi)
+{
+  return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// --- String ---
+class String
+{
+public:
+  String() {}
+  String(const char *s) : s_(s ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  String(int v) : s_(fmt("%d", v)) {}
+  String(unsigned v) : s_(fmt("%u", v)) {}
+  String(long v) : s_(fmt("%ld", v)) {}
+  String(unsigned long v) : s_(fmt("%lu", v)) {}
+  String(long long v) : s_(fmt("%lld", v)) {}
+  String(unsigned long long v) : s_(fmt("%llu", v)) {}
+  String(double v, int digits = 2) : s_(fmt("%.*f", digits, v)) {}
+  String operator+(const String &o) const { return String(s_ + o.s_); }
+  String &operator+=(const String &o)
+  {
+    s_ += o.s_;
+    return *this;
+  }
+  const char *c_str() const { return s_.c_str(); }
+  size_t length() const { return s_.size(); }
+
+private:
+  static std::string fmt(const char *f, ...)
+  {
+    char buf[64];
+    va_list ap;
+    va_start(ap, f);
+    vsnprintf(buf, sizeof(buf), f, ap);
+    va_end(ap);
+    return buf;
+  }
+  std::string s_;
+};
+inline String operator+(const char *a, const String &b) { return String(a) + b; }
+
+// --- Print / Serial : output is collected in text ---
+class Print
+{
+public:
+  size_t print(const char *s)
+  {
+    text += s;
+    return strlen(s);
+  }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t println(const char *s = "") { return print(s) + print("\n"); }
+  size_t println(const String &s) { return println(s.c_str()); }
+  int printf(const char *f, ...)
+  {
+    char buf[256];
+    va_list ap;
+    va_start(ap, f);
+    int n = vsnprintf(buf, sizeof(buf), f, ap);
+    va_end(ap);
+    print(buf);
+    return n;
+  }
+  std::string text;
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long) {}
+  void flush() {}
+};
+extern HardwareSerial Serial;
+
+// --- time : simulated clock ---
+extern unsigned long millis();
+extern unsigned long micros();
+extern void delay(unsigned long ms);
+extern void delayMicroseconds(unsigned int us);
+
+// --- pins and interrupts ---
+extern void pinMode(uint8_t pin, uint8_t mode);
+extern void digitalWrite(uint8_t pin, uint8_t val);
+extern int digitalRead(uint8_t pin);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+extern void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+extern void detachInterrupt(uint8_t pin);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// --- system ---
+extern bool setCpuFrequencyMhz(uint32_t mhz);
+extern uint32_t getCpuFrequencyMhz();
+inline void btStop() {}
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+inline const char *esp_err_to_name(esp_err_t err) { return err == ESP_OK ? "ESP_OK" : "ESP_FAIL"; }
+
+class EspClass
+{
+public:
+  uint32_t getCycleCount();
+  void restart() {}
+};
+extern EspClass ESP;
+
+// --- FreeRTOS : tasks are not run, queues work ---
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) (ms)
+extern void vTaskDelay(TickType_t ticks);
+extern void vTaskDelayUntil(TickType_t *prev, TickType_t ticks);
+extern TickType_t xTaskGetTickCount();
+extern BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stack, void *arg, int prio, TaskHandle_t *handle, int core);
+extern QueueHandle_t xQueueCreate(int len, int item_size);
+extern BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait);
+extern BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t wait);
+
+// critical sections : the simulated ISR runs synchronously, nothing to lock
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+inline void portENTER_CRITICAL(portMUX_TYPE *) {}
+inline void portEXIT_CRITICAL(portMUX_TYPE *) {}
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE *) {}
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE *) {}
+
+// -------------------------------------------------------
+#endif // _SIM_ARDUINO_H
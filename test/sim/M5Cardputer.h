@@ -0,0 +1,89 @@
+// *******************************************************
+//  Host simulator : M5Cardputer / M5Unified subset
+// -------------------------------------------------------
+// M5Cardputer.h
+//   battery level and Grove power are driven by sim.h
+// *******************************************************
+#ifndef _SIM_M5CARDPUTER_H
+#define _SIM_M5CARDPUTER_H
+// -------------------------------------------------------
+#include "M5GFX.h"
+
+namespace m5
+{
+  enum pin_name_t
+  {
+    sd_spi_sclk,
+    sd_spi_miso,
+    sd_spi_mosi,
+    sd_spi_ss
+  };
+  struct config_t
+  {
+    uint32_t serial_baudrate = 115200;
+    bool internal_imu = true;
+    bool internal_mic = true;
+    bool output_power = true;
+    uint8_t led_brightness = 0;
+  };
+}
+
+struct Point2D_t
+{
+  int x, y;
+};
+
+struct KeyValue_t
+{
+  char value_first;
+  char value_second;
+};
+
+class Keyboard_Class
+{
+public:
+  void updateKeyList() {}
+  std::vector<Point2D_t> &keyList() { return keys_; }
+  KeyValue_t getKeyValue(const Point2D_t &) { return KeyValue_t{0, 0}; }
+  bool isKeyPressed(char) { return false; }
+
+private:
+  std::vector<Point2D_t> keys_;
+};
+
+class Power_Class
+{
+public:
+  int32_t getBatteryLevel();
+  void setExtOutput(bool enable);
+  void powerOff();
+};
+
+class Speaker_Class
+{
+public:
+  void setVolume(uint8_t) {}
+};
+
+class M5_CARDPUTER
+{
+public:
+  void begin(m5::config_t, bool = true) {}
+  void update() {}
+  LGFX_Device Display;
+  Keyboard_Class Keyboard;
+  Power_Class Power;
+  Speaker_Class Speaker;
+};
+extern M5_CARDPUTER M5Cardputer;
+
+class M5Unified
+{
+public:
+  m5::config_t config() { return m5::config_t(); }
+  int8_t getPin(m5::pin_name_t) { return -1; }
+};
+extern M5Unified M5;
+
+// -------------------------------------------------------
+#endif // _SIM_M5CARDPUTER_H
@@ -0,0 +1,112 @@
+// *******************************************************
+//  Host simulator : M5GFX subset
+// -------------------------------------------------------
+// M5GFX.h
+//   drawing calls are accepted and dropped
+// *******************************************************
+#ifndef _SIM_M5GFX_H
+#define _SIM_M5GFX_H
+// -------------------------------------------------------
+#include "Arduino.h"
+
+namespace lgfx
+{
+  struct IFont
+  {
+  };
+  struct U8g2font : IFont
+  {
+    constexpr U8g2font(const uint8_t *data) : data(data) {}
+    const uint8_t *data;
+  };
+}
+
+namespace fonts
+{
+  extern const lgfx::U8g2font lgfxJapanGothic_12, lgfxJapanGothic_16, lgfxJapanGothic_24, lgfxJapanMincho_16;
+  extern const lgfx::IFont Font0, Font2, Font4, Font7;
+}
+
+enum textdatum_t : uint8_t
+{
+  top_left,
+  middle_center,
+  top_right
+};
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_SKYBLUE 0x867D
+#define TFT_GREEN 0x07E0
+#define TFT_ORANGE 0xFDA0
+#define TFT_RED 0xF800
+
+class LGFX_Device
+{
+public:
+  int width() { return 240; }
+  int height() { return 135; }
+  void setBrightness(uint8_t) {}
+  void setColorDepth(int) {}
+  void setRotation(int) {}
+};
+
+class M5Canvas
+{
+public:
+  M5Canvas() {}
+  M5Canvas(LGFX_Device *) {}
+  void setColorDepth(int depth) { depth_ = depth; }
+  int getColorDepth() { return depth_; }
+  void *createSprite(int w, int h)
+  {
+    w_ = w;
+    h_ = h;
+    return this;
+  }
+  void deleteSprite() {}
+  bool createPalette() { return true; }
+  void setPaletteColor(size_t index, uint32_t rgb888)
+  {
+    if (index < 16)
+      palette[index] = rgb888;
+  }
+  size_t bufferLength() { return (size_t)w_ * h_ * depth_ / 8; }
+
+  void pushSprite(int, int) { pushes++; }
+  void fillScreen(uint32_t) {}
+  void fillRect(int, int, int, int, uint32_t) {}
+  void drawRect(int, int, int, int, uint32_t) {}
+  void drawFastHLine(int, int, int, uint32_t) {}
+  void drawFastVLine(int, int, int, uint32_t) {}
+  void drawLine(int, int, int, int, uint32_t) {}
+  void fillCircle(int, int, int, uint32_t) {}
+  void drawCircle(int, int, int, uint32_t) {}
+  void drawPixel(int, int, uint32_t) {}
+
+  void setFont(const lgfx::IFont *) {}
+  void setTextSize(float) {}
+  void setTextDatum(textdatum_t) {}
+  void setTextWrap(bool) {}
+  void setTextColor(uint32_t) {}
+  void setTextColor(uint32_t, uint32_t) {}
+  void setCursor(int, int) {}
+  int textWidth(const char *s) { return 8 * (int)strlen(s); }
+  int fontHeight() { return 16; }
+  size_t print(const char *s) { return strlen(s); }
+  size_t drawString(const char *s, int, int, const lgfx::IFont * = nullptr) { return textWidth(s); }
+  size_t drawString(const String &s, int x, int y, const lgfx::IFont *f = nullptr) { return drawString(s.c_str(), x, y, f); }
+  size_t drawCenterString(const char *s, int, int, const lgfx::IFont * = nullptr) { return textWidth(s); }
+  size_t drawRightString(const char *s, int, int, const lgfx::IFont * = nullptr) { return textWidth(s); }
+
+  uint32_t palette[16] = {};
+  uint32_t pushes = 0;
+
+private:
+  int depth_ = 16;
+  int w_ = 0;
+  int h_ = 0;
+};
+
+// -------------------------------------------------------
+#endif // _SIM_M5GFX_H
@@ -0,0 +1,6 @@
+// Host simulator : M5Stack-SD-Updater (never launched)
+#ifndef _SIM_M5STACKUPDATER_H
+#define _SIM_M5STACKUPDATER_H
+#include "SD.h"
+inline void updateFromFS(SDFS &, const char *) {}
+#endif // _SIM_M5STACKUPDATER_H
@@ -0,0 +1,17 @@
+// Host simulator : SD card (always present, never read)
+#ifndef _SIM_SD_H
+#define _SIM_SD_H
+#include "Arduino.h"
+class SPIClass
+{
+public:
+  void begin(int8_t, int8_t, int8_t, int8_t) {}
+};
+class SDFS
+{
+public:
+  bool begin(int8_t, SPIClass &) { return true; }
+  void end() {}
+};
+extern SDFS SD;
+#endif // _SIM_SD_H
@@ -0,0 +1,11 @@
+// Host simulator : WiFi (off)
+#ifndef _SIM_WIFI_H
+#define _SIM_WIFI_H
+#define WIFI_OFF 0
+class WiFiClass
+{
+public:
+  bool mode(int) { return true; }
+};
+extern WiFiClass WiFi;
+#endif // _SIM_WIFI_H
@@ -0,0 +1,6 @@
+// Host simulator : esp_timer backed by the simulated clock (sim.h)
+#ifndef _SIM_ESP_TIMER_H
+#define _SIM_ESP_TIMER_H
+#include <stdint.h>
+extern int64_t esp_timer_get_time();
+#endif // _SIM_ESP_TIMER_H
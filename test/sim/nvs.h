@@ -0,0 +1,19 @@
+// Host simulator : NVS kept in memory
+#ifndef _SIM_NVS_H
+#define _SIM_NVS_H
+#include "Arduino.h"
+typedef uint32_t nvs_handle_t;
+typedef enum
+{
+  NVS_READONLY,
+  NVS_READWRITE
+} nvs_open_mode_t;
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+extern esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle);
+extern void nvs_close(nvs_handle_t handle);
+extern esp_err_t nvs_commit(nvs_handle_t handle);
+extern esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value);
+extern esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *value);
+extern esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+extern esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *value, size_t *length);
+#endif // _SIM_NVS_H
@@ -0,0 +1,389 @@
+#include "sim.h"
+#include "nvs.h"
+#include "esp_timer.h"
+#include "SD.h"
+#include "WiFi.h"
+#include "M5Cardputer.h"
+#include "l10n_fonts.h"
+#include <deque>
+#include <map>
+
+// ------------------------------------------------------------------------
+// Host simulator
+// ------------------------------------------------------------------------
+// One simulated clock drives esp_timer, millis() and micros(). The
+// HC-SR04 model answers a trigger (falling edge of the trigger pin) by
+// scheduling echo edges; simAdvanceUs() delivers them to the attached
+// ISR at their time, with the echo pin level set as on the device.
+// ------------------------------------------------------------------------
+namespace Sim
+{
+  constexpr uint64_t ECHO_DELAY_US = 460;       // trigger end to echo start
+  constexpr uint64_t RANGE_PULSE_US = 38500;    // no target
+  constexpr uint64_t GLITCH_US = 3;             // spurious pulse width
+  constexpr double SOUND_CM_PER_US = 0.03435;
+}
+
+struct SimEdge
+{
+  uint64_t at_us;
+  uint8_t level;
+};
+
+static uint64_t simUs = 0;
+static uint8_t pinLevel[64] = {};
+static void (*pinIsr[64])() = {};
+static std::deque<SimEdge> echoEdges; // in time order
+static SimEcho sensorMode = SIM_ECHO_OK;
+static double sensorDistance = 100.0;
+static bool sensorPowered = true;
+static uint32_t triggers = 0;
+static uint64_t lastTriggerUs = 0;
+static uint8_t batteryLevel = 100;
+static uint32_t batteryReads = 0;
+static uint32_t powerOffs = 0;
+static uint32_t extOutputSwitches = 0;
+
+static void echoLevel(uint8_t level)
+{
+  if (pinLevel[SIM_ECHO_PIN] == level)
+    return;
+  pinLevel[SIM_ECHO_PIN] = level;
+  if (pinIsr[SIM_ECHO_PIN] != nullptr)
+    pinIsr[SIM_ECHO_PIN]();
+}
+
+static void echoPulse(uint64_t start_us, uint64_t width_us)
+{
+  echoEdges.push_back({start_us, HIGH});
+  echoEdges.push_back({start_us + width_us, LOW});
+}
+
+static void sensorTrigger()
+{
+  triggers++;
+  lastTriggerUs = simUs;
+  if (!sensorPowered || !echoEdges.empty())
+    return; // off, or still busy with the last echo
+  switch (sensorMode)
+  {
+  case SIM_ECHO_OK:
+    echoPulse(simUs + Sim::ECHO_DELAY_US, (uint64_t)(sensorDistance * 2 / Sim::SOUND_CM_PER_US));
+    break;
+  case SIM_ECHO_RANGE:
+    echoPulse(simUs + Sim::ECHO_DELAY_US, Sim::RANGE_PULSE_US);
+    break;
+  default:
+    break;
+  }
+}
+
+static void sensorLine()
+{
+  // stuck line : high while powered
+  echoLevel(sensorPowered && sensorMode == SIM_ECHO_STUCK ? HIGH : LOW);
+}
+
+// --- simulator control ---
+uint64_t simNowUs()
+{
+  return simUs;
+}
+
+void simAdvanceUs(uint64_t us)
+{
+  const uint64_t target = simUs + us;
+  while (!echoEdges.empty() && echoEdges.front().at_us <= target)
+  {
+    SimEdge e = echoEdges.front();
+    echoEdges.pop_front();
+    simUs = max(simUs, e.at_us);
+    if (sensorPowered && sensorMode != SIM_ECHO_STUCK)
+      echoLevel(e.level);
+  }
+  simUs = target;
+}
+
+void simSetUs(uint64_t us)
+{
+  if (us > simUs)
+    simAdvanceUs(us - simUs);
+}
+
+void simReboot()
+{
+  simUs = 0;
+  echoEdges.clear();
+}
+
+void simSensor(SimEcho mode, double distance_cm)
+{
+  sensorMode = mode;
+  sensorDistance = distance_cm;
+  echoEdges.clear();
+  sensorLine();
+}
+
+void simSpuriousEdges(uint8_t pulses)
+{
+  for (uint8_t i = 0; i < pulses; ++i)
+    echoPulse(simUs + 1 + i * 2 * Sim::GLITCH_US, Sim::GLITCH_US);
+}
+
+uint32_t simTriggers()
+{
+  return triggers;
+}
+
+uint64_t simLastTriggerUs()
+{
+  return lastTriggerUs;
+}
+
+void simBattery(uint8_t level)
+{
+  batteryLevel = level;
+}
+
+uint32_t simBatteryReads()
+{
+  return batteryReads;
+}
+
+uint32_t simPowerOffs()
+{
+  return powerOffs;
+}
+
+uint32_t simExtOutputSwitches()
+{
+  return extOutputSwitches;
+}
+
+// --- esp_timer / Arduino time ---
+int64_t esp_timer_get_time()
+{
+  return (int64_t)simUs;
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(uint32_t)(simUs / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)(uint32_t)simUs;
+}
+
+void delay(unsigned long ms)
+{
+  simAdvanceUs(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  simAdvanceUs(us);
+}
+
+// --- pins and interrupts ---
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  const uint8_t prev = pinLevel[pin];
+  pinLevel[pin] = val ? HIGH : LOW;
+  if (pin == SIM_TRIG_PIN && prev == HIGH && val == LOW)
+    sensorTrigger();
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pinLevel[pin];
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int)
+{
+  pinIsr[pin] = isr;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  pinIsr[pin] = nullptr;
+}
+
+// --- system ---
+static uint32_t cpuMhz = 240;
+bool setCpuFrequencyMhz(uint32_t mhz)
+{
+  cpuMhz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz()
+{
+  return cpuMhz;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(simUs * cpuMhz);
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+SDFS SD;
+WiFiClass WiFi;
+
+// --- FreeRTOS ---
+void vTaskDelay(TickType_t ticks)
+{
+  delay(ticks);
+}
+
+void vTaskDelayUntil(TickType_t *prev, TickType_t ticks)
+{
+  *prev += ticks;
+}
+
+TickType_t xTaskGetTickCount()
+{
+  return (TickType_t)(simUs / 1000);
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*)(void *), const char *, uint32_t, void *, int, TaskHandle_t *, int)
+{
+  return pdPASS; // tasks do not run in the simulator
+}
+
+struct SimQueue
+{
+  size_t len;
+  size_t item_size;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(int len, int item_size)
+{
+  return new SimQueue{(size_t)len, (size_t)item_size, {}};
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t)
+{
+  SimQueue *sq = static_cast<SimQueue *>(q);
+  if (sq->items.size() >= sq->len)
+    return pdFALSE;
+  const uint8_t *p = static_cast<const uint8_t *>(item);
+  sq->items.push_back(std::vector<uint8_t>(p, p + sq->item_size));
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t)
+{
+  SimQueue *sq = static_cast<SimQueue *>(q);
+  if (sq->items.empty())
+    return pdFALSE;
+  memcpy(item, sq->items.front().data(), sq->item_size);
+  sq->items.pop_front();
+  return pdTRUE;
+}
+
+// --- NVS ---
+static std::map<std::string, std::vector<uint8_t>> nvsStore;
+
+void simNvsErase()
+{
+  nvsStore.clear();
+}
+
+esp_err_t nvs_open(const char *, nvs_open_mode_t, nvs_handle_t *handle)
+{
+  *handle = 1;
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t)
+{
+}
+
+esp_err_t nvs_commit(nvs_handle_t)
+{
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t h, const char *key, uint8_t value)
+{
+  return nvs_set_blob(h, key, &value, 1);
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t h, const char *key, uint8_t *value)
+{
+  size_t len = 1;
+  return nvs_get_blob(h, key, value, &len);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t, const char *key, const void *value, size_t length)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(value);
+  nvsStore[key] = std::vector<uint8_t>(p, p + length);
+  return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t, const char *key, void *value, size_t *length)
+{
+  auto it = nvsStore.find(key);
+  if (it == nvsStore.end())
+    return ESP_ERR_NVS_NOT_FOUND;
+  if (value != nullptr)
+  {
+    if (*length < it->second.size())
+      return ESP_FAIL;
+    memcpy(value, it->second.data(), it->second.size());
+  }
+  *length = it->second.size();
+  return ESP_OK;
+}
+
+// --- M5Cardputer ---
+M5_CARDPUTER M5Cardputer;
+M5Unified M5;
+
+int32_t Power_Class::getBatteryLevel()
+{
+  batteryReads++;
+  return batteryLevel;
+}
+
+void Power_Class::setExtOutput(bool enable)
+{
+  extOutputSwitches++;
+  sensorPowered = enable;
+  echoEdges.clear();
+  sensorLine();
+}
+
+void Power_Class::powerOff()
+{
+  powerOffs++;
+}
+
+// --- fonts : full fonts, as l10n_fonts.gen.cpp without font sources ---
+namespace fonts
+{
+  const lgfx::U8g2font lgfxJapanGothic_12(nullptr), lgfxJapanGothic_16(nullptr), lgfxJapanGothic_24(nullptr), lgfxJapanMincho_16(nullptr);
+  const lgfx::IFont Font0, Font2, Font4, Font7;
+}
+const lgfx::IFont *const L10N_FONT_G12 = &fonts::lgfxJapanGothic_12;
+const lgfx::IFont *const L10N_FONT_G16 = &fonts::lgfxJapanGothic_16;
+const lgfx::IFont *const L10N_FONT_G24 = &fonts::lgfxJapanGothic_24;
+const lgfx::IFont *const L10N_FONT_M16 = &fonts::lgfxJapanMincho_16;
+// widths unknown (-1) : the same fallback as a build with the full fonts
+static_assert(LANG_NUM == 2, "one L10N_WIDTH_G24 row per language");
+const int16_t L10N_WIDTH_G24[LANG_NUM][MSG_NUM] = {
+#define MSG(id, en, ja) -1,
+    {L10N_MESSAGES},
+    {L10N_MESSAGES},
+#undef MSG
+};
@@ -0,0 +1,48 @@
+// *******************************************************
+//  Host simulator        ( pio test -e native )
+// -------------------------------------------------------
+// sim.h
+//   simulated clock, HC-SR04 model with injectable faults,
+//   battery level and Grove 5V output
+// *******************************************************
+#ifndef _SIM_H
+#define _SIM_H
+// -------------------------------------------------------
+#include "Arduino.h"
+
+// HC-SR04 pins of main.cpp
+constexpr uint8_t SIM_ECHO_PIN = 1;
+constexpr uint8_t SIM_TRIG_PIN = 2;
+
+// --- clock [us] : esp_timer_get_time(), millis(), micros() ---
+// delay() and delayMicroseconds() advance it, echo edges scheduled
+// before the new time are delivered to the ISR on the way.
+extern uint64_t simNowUs();
+extern void simSetUs(uint64_t us); // jump forward to an absolute time
+extern void simAdvanceUs(uint64_t us);
+extern void simReboot(); // clock back to 0 as after a power cycle, NVS kept
+
+// --- HC-SR04 model : answers every trigger by the mode ---
+enum SimEcho : uint8_t
+{
+  SIM_ECHO_OK,     // echo pulse for the set distance
+  SIM_ECHO_RANGE,  // no target : ~38 ms out-of-range pulse
+  SIM_ECHO_SILENT, // dead sensor : no edge at all
+  SIM_ECHO_STUCK,  // echo line stuck high
+};
+extern void simSensor(SimEcho mode, double distance_cm = 100.0);
+extern void simSpuriousEdges(uint8_t pulses); // short glitch pulses now
+extern uint32_t simTriggers();                // trigger pulses sent
+extern uint64_t simLastTriggerUs();
+
+// --- battery / power ---
+extern void simBattery(uint8_t level);
+extern uint32_t simBatteryReads();
+extern uint32_t simPowerOffs();
+extern uint32_t simExtOutputSwitches();
+
+// --- NVS (in memory) ---
+extern void simNvsErase();
+
+// -------------------------------------------------------
+#endif // _SIM_H
@@ -0,0 +1,62 @@
+// *******************************************************
+//  Burst ping spacing
+// -------------------------------------------------------
+//  pio test -e native -f test_burst
+//  With the shortest burst gap and a near target, pings
+//  must still be MIN_CYCLE_MS (60 ms) apart, trigger to
+//  trigger, and every ping of the burst must be valid.
+// *******************************************************
+#include <unity.h>
+#include "sim.h"
+#include "N_util.h"
+#include "N_rrd.h"
+
+extern void setup();
+extern void loop();
+
+static constexpr uint64_t MIN_CYCLE_US = 60 * 1000;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_burst_trigger_to_trigger(void)
+{
+  simSensor(SIM_ECHO_OK, 10.0); // echo ends ~1 ms after the trigger
+  const uint32_t triggers0 = simTriggers();
+  uint32_t seen = triggers0;
+  uint64_t prev = 0, minGap = UINT64_MAX;
+  const uint64_t end = simNowUs() + 3 * 1000 * 1000ULL;
+  while (simNowUs() < end)
+  {
+    loop();
+    if (simTriggers() == seen)
+      continue;
+    if (seen != triggers0)
+      minGap = min(minGap, simLastTriggerUs() - prev);
+    prev = simLastTriggerUs();
+    seen = simTriggers();
+  }
+  TEST_ASSERT_TRUE(seen - triggers0 >= 2 * 16); // two or more full bursts
+  TEST_ASSERT_TRUE(minGap >= MIN_CYCLE_US);
+
+  RrdBucket b;
+  TEST_ASSERT_TRUE(rrdGet(RRD_RAW, 0, b));
+  TEST_ASSERT_FLOAT_WITHIN(0.5, 10.0, b.min);
+}
+
+int main(int, char **)
+{
+  // K = 16 pings, 10 ms gap : the settings are read from NVS by setup()
+  wrtNVS("bk", 16);
+  wrtNVS("bgap", 10);
+  setup();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_burst_trigger_to_trigger);
+  return UNITY_END();
+}
@@ -0,0 +1,213 @@
+// *******************************************************
+//  Sensor health monitor and recovery
+// -------------------------------------------------------
+//  pio test -e native -f test_health
+//  N_health classification and back-off fed with ping
+//  results, then the recovery of main.cpp in the
+//  simulator : a dead sensor is re-initialised and the
+//  Grove 5V power cycle does not block the loop.
+// *******************************************************
+#include <unity.h>
+#include "sim.h"
+#include "N_util.h"
+#include "N_health.h"
+
+extern void setup();
+extern void loop();
+
+static constexpr uint64_t PING_US = 100 * 1000ULL; // ping spacing of the unit tests
+static constexpr uint64_t SEC_US = 1000 * 1000ULL;
+
+// one ping report, then the clock advances by PING_US
+static HealthAction ping(PingResult result, uint8_t spurious = 0, bool echoHigh = false)
+{
+  HealthAction action = healthPing(result, spurious, echoHigh);
+  simAdvanceUs(PING_US);
+  return action;
+}
+
+// silent pings until a recovery action : its time [us]
+static uint64_t nextRecovery(HealthAction &action)
+{
+  for (int i = 0; i < 1000; ++i)
+  {
+    const uint64_t t = simNowUs();
+    action = ping(PING_TIMEOUT);
+    if (action != HA_NONE)
+      return t;
+  }
+  action = HA_NONE;
+  return 0;
+}
+
+void setUp(void)
+{
+  healthBegin(true);
+}
+
+void tearDown(void)
+{
+}
+
+void test_stuck_after_4_pings(void)
+{
+  for (int i = 0; i < 3; ++i)
+    TEST_ASSERT_EQUAL(HA_NONE, ping(PING_TIMEOUT, 0, true));
+  TEST_ASSERT_EQUAL(SH_OK, healthState());
+  TEST_ASSERT_EQUAL(HA_REINIT, ping(PING_TIMEOUT, 0, true));
+  TEST_ASSERT_EQUAL(SH_STUCK, healthState());
+}
+
+void test_dead_after_8_pings(void)
+{
+  for (int i = 0; i < 7; ++i)
+    TEST_ASSERT_EQUAL(HA_NONE, ping(PING_TIMEOUT));
+  TEST_ASSERT_EQUAL(SH_OK, healthState());
+  TEST_ASSERT_EQUAL(HA_REINIT, ping(PING_TIMEOUT));
+  TEST_ASSERT_EQUAL(SH_DEAD, healthState());
+}
+
+void test_degraded_by_faults(void)
+{
+  // timeouts with edges on the line : not silent, so not dead
+  for (int i = 0; i < 7; ++i)
+    TEST_ASSERT_EQUAL(HA_NONE, ping(PING_TIMEOUT, 2));
+  TEST_ASSERT_EQUAL(SH_OK, healthState());
+  TEST_ASSERT_EQUAL(HA_NONE, ping(PING_OK, 1));
+  TEST_ASSERT_EQUAL(SH_DEGRADED, healthState());
+  TEST_ASSERT_EQUAL_UINT8(7, healthStats().winTimeouts);
+  TEST_ASSERT_EQUAL_UINT8(8, healthStats().winSpurious);
+}
+
+void test_out_of_range_does_not_degrade(void)
+{
+  // no target in the field of view : counted, not a fault
+  for (int i = 0; i < HEALTH_WINDOW; ++i)
+    TEST_ASSERT_EQUAL(HA_NONE, ping(PING_RANGE));
+  TEST_ASSERT_EQUAL(SH_OK, healthState());
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_WINDOW, healthStats().winRanges);
+  TEST_ASSERT_EQUAL_UINT32(HEALTH_WINDOW, healthStats().ranges);
+}
+
+void test_backoff_5_10_20_40_60_s(void)
+{
+  static const uint64_t EXPECT_S[] = {5, 10, 20, 40, 60, 60};
+  HealthAction action;
+  uint64_t prev = nextRecovery(action);
+  TEST_ASSERT_EQUAL(HA_REINIT, action);
+  for (uint64_t s : EXPECT_S)
+  {
+    const uint64_t t = nextRecovery(action);
+    TEST_ASSERT_EQUAL(HA_POWER_CYCLE, action);
+    TEST_ASSERT_TRUE(t - prev >= s * SEC_US);
+    TEST_ASSERT_TRUE(t - prev < s * SEC_US + PING_US);
+    prev = t;
+  }
+  TEST_ASSERT_EQUAL_UINT32(7, healthStats().recoveries);
+}
+
+void test_reset_after_ping_ok(void)
+{
+  HealthAction action;
+  uint64_t prev = nextRecovery(action);
+  for (int i = 0; i < 3; ++i)
+    prev = nextRecovery(action); // back-off at 20 s
+  TEST_ASSERT_EQUAL(HA_POWER_CYCLE, action);
+
+  TEST_ASSERT_EQUAL(HA_NONE, ping(PING_OK));
+  TEST_ASSERT_EQUAL(SH_DEGRADED, healthState()); // the timeouts are still in the window
+
+  // dead again : re-init first, then the 5 s interval
+  prev = nextRecovery(action);
+  TEST_ASSERT_EQUAL(HA_REINIT, action);
+  const uint64_t t = nextRecovery(action);
+  TEST_ASSERT_EQUAL(HA_POWER_CYCLE, action);
+  TEST_ASSERT_TRUE(t - prev < 5 * SEC_US + PING_US);
+}
+
+void test_no_power_cycle_without_switch(void)
+{
+  healthBegin(false); // Cardputer : Grove 5V not switchable
+  HealthAction action;
+  for (int i = 0; i < 4; ++i)
+  {
+    nextRecovery(action);
+    TEST_ASSERT_EQUAL(HA_REINIT, action);
+  }
+}
+
+// --- main.cpp in the simulator ---
+
+// loop() until cond or timeout_us : true if cond
+template <typename F>
+static bool loopUntil(F cond, uint64_t timeout_us)
+{
+  const uint64_t end = simNowUs() + timeout_us;
+  while (!cond())
+  {
+    if (simNowUs() >= end)
+      return false;
+    loop();
+  }
+  return true;
+}
+
+void test_app_recovers_dead_sensor(void)
+{
+  healthBegin(SENSOR_POWER_SWITCH != 0); // as setup()
+  simSensor(SIM_ECHO_SILENT);
+  TEST_ASSERT_TRUE(loopUntil([] { return healthState() == SH_DEAD; }, 20 * SEC_US));
+  TEST_ASSERT_TRUE(loopUntil([] { return healthStats().recoveries >= 3; }, 60 * SEC_US));
+  TEST_ASSERT_EQUAL_UINT32(0, simExtOutputSwitches()); // re-init only
+
+  simSensor(SIM_ECHO_OK, 80.0);
+  TEST_ASSERT_TRUE(loopUntil([] { return healthState() != SH_DEAD && healthState() != SH_STUCK; }, 5 * SEC_US));
+  TEST_ASSERT_TRUE(loopUntil([] { return healthState() == SH_OK; }, 60 * SEC_US)); // window clear
+}
+
+void test_app_power_cycle_does_not_block(void)
+{
+  healthBegin(true); // a board that can switch the Grove 5V
+  simSensor(SIM_ECHO_STUCK);
+  TEST_ASSERT_TRUE(loopUntil([] { return healthStats().recoveries == 2; }, 30 * SEC_US));
+  TEST_ASSERT_EQUAL_UINT32(1, simExtOutputSwitches()); // off
+
+  // the loop keeps running while the sensor is off and settling : 1 ms steps,
+  // no trigger until it is on again
+  const uint32_t triggers0 = simTriggers();
+  const uint64_t off_us = simNowUs();
+  uint64_t maxStep = 0;
+  while (simExtOutputSwitches() < 2 || simTriggers() == triggers0)
+  {
+    const uint64_t t = simNowUs();
+    loop();
+    maxStep = max(maxStep, simNowUs() - t);
+    if (simTriggers() != triggers0)
+      break;
+  }
+  TEST_ASSERT_EQUAL_UINT32(2, simExtOutputSwitches()); // on again
+  TEST_ASSERT_TRUE(maxStep < 2000);
+  TEST_ASSERT_TRUE(simLastTriggerUs() - off_us >= 300 * 1000ULL); // off 200 ms + settle 100 ms
+
+  simSensor(SIM_ECHO_OK, 80.0);
+  TEST_ASSERT_TRUE(loopUntil([] { return healthState() != SH_DEAD && healthState() != SH_STUCK; }, 5 * SEC_US));
+  TEST_ASSERT_TRUE(loopUntil([] { return healthState() == SH_OK; }, 60 * SEC_US)); // window clear
+}
+
+int main(int, char **)
+{
+  simBattery(80);
+  setup();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_stuck_after_4_pings);
+  RUN_TEST(test_dead_after_8_pings);
+  RUN_TEST(test_degraded_by_faults);
+  RUN_TEST(test_out_of_range_does_not_degrade);
+  RUN_TEST(test_backoff_5_10_20_40_60_s);
+  RUN_TEST(test_reset_after_ping_ok);
+  RUN_TEST(test_no_power_cycle_without_switch);
+  RUN_TEST(test_app_recovers_dead_sensor);
+  RUN_TEST(test_app_power_cycle_does_not_block);
+  return UNITY_END();
+}
@@ -0,0 +1,123 @@
+// *******************************************************
+//  Motion estimator (approach / recede rate)
+// -------------------------------------------------------
+//  pio test -e native -f test_motion
+//  motionAdd() / motionVelocity() of main.cpp fed with a
+//  target moving at a known speed : the least-squares
+//  slope must match it, also across a time re-base, and
+//  the fit must restart after a gap and drop when stale.
+// *******************************************************
+#include <unity.h>
+#include <math.h>
+#include "sim.h"
+#include "N_util.h"
+
+extern void motionReset();
+extern void motionAdd(uint64_t ts_us, double distance);
+extern double motionVelocity();
+
+static constexpr uint64_t SEC_US = 1000 * 1000ULL;
+static constexpr uint64_t WRAP_MS = (1ULL << 32) * 1000; // millis() wraps [us]
+static constexpr double TOL = 0.01;                       // [cm/s]
+
+// one sample at the current time, then the clock advances by step_us
+static void sample(double distance, uint64_t step_us)
+{
+  motionAdd(simNowUs(), distance);
+  simAdvanceUs(step_us);
+}
+
+// samples of a target at d0 + speed * t, every step_us, for n steps
+static void move(double d0, double speed, uint64_t step_us, int n)
+{
+  const uint64_t t0 = simNowUs();
+  for (int i = 0; i < n; ++i)
+    sample(d0 + speed * (simNowUs() - t0) * 1e-6, step_us);
+}
+
+void setUp(void)
+{
+  motionReset();
+  simAdvanceUs(10 * SEC_US); // clear of the previous test
+}
+
+void tearDown(void)
+{
+}
+
+void test_needs_min_samples(void)
+{
+  sample(100.0, 100 * 1000);
+  sample(101.0, 100 * 1000);
+  TEST_ASSERT_TRUE(isnan(motionVelocity()));
+  sample(102.0, 100 * 1000);
+  TEST_ASSERT_FLOAT_WITHIN(TOL, 10.0, motionVelocity());
+}
+
+void test_receding_speed(void)
+{
+  move(50.0, 30.0, 100 * 1000, 20);
+  TEST_ASSERT_FLOAT_WITHIN(TOL, 30.0, motionVelocity());
+}
+
+void test_approaching_speed(void)
+{
+  move(300.0, -50.0, 250 * 1000, 20);
+  TEST_ASSERT_FLOAT_WITHIN(TOL, -50.0, motionVelocity());
+}
+
+void test_speed_change_follows_window(void)
+{
+  // after WINDOW samples at the new speed, the old ones are out of the fit
+  move(100.0, 20.0, 100 * 1000, 12);
+  move(124.0, -20.0, 100 * 1000, 8);
+  TEST_ASSERT_FLOAT_WITHIN(TOL, -20.0, motionVelocity());
+}
+
+void test_speed_across_rebase(void)
+{
+  // 2 cm/s at 1 sample/s for 3 min, the time base moves every 60 s, and
+  // the timestamps are past 2^32 ms
+  simSetUs(WRAP_MS - 90 * SEC_US);
+  const uint64_t t0 = simNowUs();
+  for (int i = 0; i < 180; ++i)
+  {
+    sample(400.0 + 2.0 * (simNowUs() - t0) * 1e-6, SEC_US);
+    if (i >= 2)
+      TEST_ASSERT_FLOAT_WITHIN(TOL, 2.0, motionVelocity());
+  }
+}
+
+void test_gap_restarts_fit(void)
+{
+  move(100.0, 10.0, 100 * 1000, 10);
+  simAdvanceUs(5 * SEC_US); // with the last step : 5.1 s > MAX_GAP_US since the last sample
+  sample(80.0, 100 * 1000); // the target was moved meanwhile
+  TEST_ASSERT_TRUE(isnan(motionVelocity()));
+  sample(79.0, 100 * 1000);
+  sample(78.0, 100 * 1000);
+  TEST_ASSERT_FLOAT_WITHIN(TOL, -10.0, motionVelocity());
+}
+
+void test_stale_fit_dropped(void)
+{
+  move(100.0, 10.0, 100 * 1000, 10);
+  TEST_ASSERT_FLOAT_WITHIN(TOL, 10.0, motionVelocity());
+  simAdvanceUs(5 * SEC_US); // no valid sample since
+  TEST_ASSERT_TRUE(isnan(motionVelocity()));
+  sample(150.0, 100 * 1000);
+  TEST_ASSERT_TRUE(isnan(motionVelocity())); // the old samples are gone
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_needs_min_samples);
+  RUN_TEST(test_receding_speed);
+  RUN_TEST(test_approaching_speed);
+  RUN_TEST(test_speed_change_follows_window);
+  RUN_TEST(test_speed_across_rebase);
+  RUN_TEST(test_gap_restarts_fit);
+  RUN_TEST(test_stale_fit_dropped);
+  return UNITY_END();
+}
@@ -0,0 +1,219 @@
+// *******************************************************
+//  Round-robin time-series store
+// -------------------------------------------------------
+//  pio test -e native -f test_rrd
+//  N_rrd fed on the simulated clock from a new store :
+//  minute / hour roll-over and merge order, empty buckets
+//  for a multi-hour gap, ring wrap-around, and a checkpoint
+//  restored by rrdBegin() after a reboot.
+// *******************************************************
+#include <unity.h>
+#include "sim.h"
+#include "N_util.h"
+#include "N_rrd.h"
+
+static constexpr uint64_t SEC_US = 1000 * 1000ULL;
+
+// sample at store time t_s (the store starts at boot, t = 0)
+static void addAt(uint32_t t_s, float value)
+{
+  simSetUs(t_s * SEC_US);
+  rrdAdd(value);
+}
+
+static RrdBucket get(RrdTier tier, uint16_t age)
+{
+  RrdBucket b = {-1.0f, -1.0f, -1.0f, 0xFFFFFFFF};
+  TEST_ASSERT_TRUE(rrdGet(tier, age, b));
+  return b;
+}
+
+static void assertBucket(float min, float max, float sum, uint32_t count, const RrdBucket &b)
+{
+  TEST_ASSERT_EQUAL_UINT32(count, b.count);
+  TEST_ASSERT_EQUAL_FLOAT(min, b.min);
+  TEST_ASSERT_EQUAL_FLOAT(max, b.max);
+  TEST_ASSERT_EQUAL_FLOAT(sum, b.sum);
+}
+
+void setUp(void)
+{
+  // new store, booted at t = 0
+  simNvsErase();
+  simReboot();
+  rrdBegin();
+}
+
+void tearDown(void)
+{
+}
+
+void test_minute_boundary(void)
+{
+  addAt(10, 10.0f);
+  addAt(30, 20.0f);
+  addAt(61, 40.0f);
+
+  TEST_ASSERT_EQUAL_UINT16(3, rrdCount(RRD_RAW));
+  assertBucket(40.0f, 40.0f, 40.0f, 1, get(RRD_RAW, 0));
+  assertBucket(10.0f, 10.0f, 10.0f, 1, get(RRD_RAW, 2));
+
+  TEST_ASSERT_EQUAL_UINT16(2, rrdCount(RRD_MINUTE)); // closed minute 0 + open minute 1
+  assertBucket(40.0f, 40.0f, 40.0f, 1, get(RRD_MINUTE, 0));
+  assertBucket(10.0f, 20.0f, 30.0f, 2, get(RRD_MINUTE, 1));
+  assertBucket(10.0f, 20.0f, 30.0f, 2, get(RRD_HOUR, 0)); // merged into the open hour
+}
+
+void test_hour_boundary_merge_order(void)
+{
+  // one sample per minute, value = minute number, into the second hour
+  for (uint32_t m = 0; m <= 60; ++m)
+    addAt(m * 60 + 30, (float)m);
+
+  // minute 59 closes before hour 0 : it is part of the hour bucket
+  TEST_ASSERT_EQUAL_UINT16(2, rrdCount(RRD_HOUR));
+  assertBucket(0.0f, 59.0f, 59.0f * 60 / 2, 60, get(RRD_HOUR, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_HOUR, 0).count); // minute 60 is still open
+  assertBucket(60.0f, 60.0f, 60.0f, 1, get(RRD_MINUTE, 0));
+  assertBucket(59.0f, 59.0f, 59.0f, 1, get(RRD_MINUTE, 1));
+
+  // and the hour was merged into the open day
+  assertBucket(0.0f, 59.0f, 59.0f * 60 / 2, 60, get(RRD_DAY, 0));
+}
+
+void test_periods_close_without_samples(void)
+{
+  addAt(30, 5.0f);
+  simSetUs(125 * SEC_US);
+  rrdService(); // minute 0 and the empty minute 1 close on time
+  TEST_ASSERT_EQUAL_UINT16(3, rrdCount(RRD_MINUTE));
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_MINUTE, 0).count);
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_MINUTE, 1).count);
+  assertBucket(5.0f, 5.0f, 5.0f, 1, get(RRD_MINUTE, 2));
+}
+
+void test_multi_hour_gap(void)
+{
+  addAt(30, 7.0f);
+  addAt(3 * 3600 + 30, 8.0f); // nothing for 3 hours
+
+  // the minute ring is all empty buckets : the gap is longer than its span
+  TEST_ASSERT_EQUAL_UINT16(61, rrdCount(RRD_MINUTE));
+  assertBucket(8.0f, 8.0f, 8.0f, 1, get(RRD_MINUTE, 0));
+  for (uint16_t age = 1; age < 61; ++age)
+    TEST_ASSERT_EQUAL_UINT32(0, get(RRD_MINUTE, age).count);
+
+  // hour 0 holds the first sample, hours 1 and 2 are empty, and the open
+  // hour 3 gets the new sample when its minute closes
+  TEST_ASSERT_EQUAL_UINT16(4, rrdCount(RRD_HOUR));
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_HOUR, 0).count);
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_HOUR, 1).count);
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_HOUR, 2).count);
+  assertBucket(7.0f, 7.0f, 7.0f, 1, get(RRD_HOUR, 3));
+  RrdBucket b;
+  TEST_ASSERT_FALSE(rrdGet(RRD_HOUR, 4, b));
+
+  // the day is still open and has the closed hour 0
+  TEST_ASSERT_EQUAL_UINT16(1, rrdCount(RRD_DAY));
+  assertBucket(7.0f, 7.0f, 7.0f, 1, get(RRD_DAY, 0));
+}
+
+void test_gap_longer_than_ring(void)
+{
+  addAt(30, 1.0f);
+  addAt(100 * 3600 + 30, 2.0f); // 100 hours : day 4, more minutes than the ring
+  TEST_ASSERT_EQUAL_UINT16(61, rrdCount(RRD_MINUTE));
+  TEST_ASSERT_EQUAL_UINT16(101, rrdCount(RRD_HOUR)); // hour 0, 99 empty, open
+  assertBucket(1.0f, 1.0f, 1.0f, 1, get(RRD_HOUR, 100));
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_HOUR, 1).count);
+
+  TEST_ASSERT_EQUAL_UINT16(5, rrdCount(RRD_DAY)); // day 0, days 1 .. 3 empty, open day 4
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_DAY, 0).count); // the new sample is in the open minute
+  assertBucket(2.0f, 2.0f, 2.0f, 1, get(RRD_MINUTE, 0));
+  for (uint16_t age = 1; age < 4; ++age)
+    TEST_ASSERT_EQUAL_UINT32(0, get(RRD_DAY, age).count);
+  assertBucket(1.0f, 1.0f, 1.0f, 1, get(RRD_DAY, 4));
+}
+
+void test_raw_ring_wraps(void)
+{
+  for (int i = 0; i < 75; ++i)
+    addAt(i, (float)i);
+  TEST_ASSERT_EQUAL_UINT16(60, rrdCount(RRD_RAW));
+  assertBucket(74.0f, 74.0f, 74.0f, 1, get(RRD_RAW, 0));
+  assertBucket(15.0f, 15.0f, 15.0f, 1, get(RRD_RAW, 59)); // the oldest kept
+  RrdBucket b;
+  TEST_ASSERT_FALSE(rrdGet(RRD_RAW, 60, b));
+}
+
+void test_minute_ring_wraps(void)
+{
+  for (uint32_t m = 0; m < 70; ++m)
+    addAt(m * 60 + 1, (float)m);
+  TEST_ASSERT_EQUAL_UINT16(61, rrdCount(RRD_MINUTE)); // full ring + open bucket
+  assertBucket(69.0f, 69.0f, 69.0f, 1, get(RRD_MINUTE, 0));
+  assertBucket(68.0f, 68.0f, 68.0f, 1, get(RRD_MINUTE, 1));
+  assertBucket(9.0f, 9.0f, 9.0f, 1, get(RRD_MINUTE, 60)); // minutes 0 .. 8 overwritten
+}
+
+void test_checkpoint_restored_after_reboot(void)
+{
+  for (uint32_t t = 5; t < 3 * 3600; t += 97)
+    addAt(t, (float)(t % 400));
+  simSetUs(3 * 3600 * SEC_US + 20 * SEC_US);
+  rrdCheckpoint(); // store time 10820 s
+
+  // snapshot of every tier
+  static RrdBucket before[RRD_TIER_NUM][200];
+  uint16_t counts[RRD_TIER_NUM];
+  for (uint8_t tier = 0; tier < RRD_TIER_NUM; ++tier)
+  {
+    counts[tier] = rrdCount((RrdTier)tier);
+    for (uint16_t age = 0; age < counts[tier]; ++age)
+      before[tier][age] = get((RrdTier)tier, age);
+  }
+
+  // reboot : the clock restarts at 0, the store time continues
+  simReboot();
+  rrdBegin();
+  for (uint8_t tier = 0; tier < RRD_TIER_NUM; ++tier)
+  {
+    TEST_ASSERT_EQUAL_UINT16(counts[tier], rrdCount((RrdTier)tier));
+    for (uint16_t age = 0; age < counts[tier]; ++age)
+    {
+      const RrdBucket &b = before[tier][age];
+      assertBucket(b.min, b.max, b.sum, b.count, get((RrdTier)tier, age));
+    }
+  }
+
+  // 10 s after the boot is store time 10830 s : still the same open minute
+  const RrdBucket open = before[RRD_MINUTE][0];
+  addAt(10, 1000.0f);
+  TEST_ASSERT_EQUAL_UINT16(counts[RRD_MINUTE], rrdCount(RRD_MINUTE));
+  TEST_ASSERT_EQUAL_UINT32(open.count + 1, get(RRD_MINUTE, 0).count);
+  TEST_ASSERT_EQUAL_FLOAT(1000.0f, get(RRD_MINUTE, 0).max);
+}
+
+void test_new_store_without_checkpoint(void)
+{
+  addAt(30, 3.0f);
+  simReboot(); // no checkpoint : nothing to restore
+  rrdBegin();
+  TEST_ASSERT_EQUAL_UINT16(0, rrdCount(RRD_RAW));
+  TEST_ASSERT_EQUAL_UINT32(0, get(RRD_MINUTE, 0).count);
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_minute_boundary);
+  RUN_TEST(test_hour_boundary_merge_order);
+  RUN_TEST(test_periods_close_without_samples);
+  RUN_TEST(test_multi_hour_gap);
+  RUN_TEST(test_gap_longer_than_ring);
+  RUN_TEST(test_raw_ring_wraps);
+  RUN_TEST(test_minute_ring_wraps);
+  RUN_TEST(test_checkpoint_restored_after_reboot);
+  RUN_TEST(test_new_store_without_checkpoint);
+  return UNITY_END();
+}
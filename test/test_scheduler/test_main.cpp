@@ -0,0 +1,163 @@
+// *******************************************************
+//  Schedulers of main.cpp across the 32-bit wrap points
+// -------------------------------------------------------
+//  pio test -e native -f test_scheduler
+//  The app runs in the host simulator (setup() / loop())
+//  with the clock fast-forwarded to just before 2^32 us
+//  and 2^32 ms : SR04 trigger / timeout and battery check
+//  must keep their intervals.
+// *******************************************************
+#include <unity.h>
+#include "sim.h"
+#include "N_util.h"
+#include "N_rrd.h"
+#include "N_health.h"
+
+extern void setup();
+extern void loop();
+
+static constexpr uint64_t WRAP_US = 1ULL << 32;          // micros() wraps
+static constexpr uint64_t WRAP_MS = (1ULL << 32) * 1000; // millis() wraps [us]
+static constexpr uint64_t CHECK_INTERVAL_US = 1000 * 1000;
+static constexpr uint64_t BATTERY_INTERVAL_US = 1993 * 1000;
+
+struct RunLog
+{
+  uint32_t triggers;
+  uint64_t firstUs, lastUs;
+  uint64_t minGapUs, maxGapUs; // between triggers
+  uint32_t batteryReads;
+};
+
+// loop() for run_us of simulated time, trigger times logged
+static RunLog runLoop(uint64_t run_us)
+{
+  RunLog log = {0, 0, 0, UINT64_MAX, 0, 0};
+  const uint32_t triggers0 = simTriggers();
+  const uint32_t reads0 = simBatteryReads();
+  const uint64_t end = simNowUs() + run_us;
+  uint64_t prev = 0;
+  while (simNowUs() < end)
+  {
+    loop(); // vTaskDelay(1) advances the clock by 1 ms
+    if (simTriggers() - triggers0 == log.triggers)
+      continue;
+    log.triggers = simTriggers() - triggers0;
+    const uint64_t t = simLastTriggerUs();
+    if (log.triggers == 1)
+      log.firstUs = t;
+    else
+    {
+      log.minGapUs = min(log.minGapUs, t - prev);
+      log.maxGapUs = max(log.maxGapUs, t - prev);
+    }
+    prev = t;
+    log.lastUs = t;
+  }
+  log.batteryReads = simBatteryReads() - reads0;
+  return log;
+}
+
+static void checkTriggerAcross(uint64_t boundary_us)
+{
+  simSensor(SIM_ECHO_OK, 50.0);
+  simSetUs(boundary_us - 4500 * 1000ULL);
+  RunLog log = runLoop(9 * CHECK_INTERVAL_US);
+
+  TEST_ASSERT_EQUAL_UINT32(9, log.triggers);
+  TEST_ASSERT_TRUE(log.firstUs < boundary_us && log.lastUs > boundary_us);
+  TEST_ASSERT_TRUE(log.minGapUs >= CHECK_INTERVAL_US);
+  TEST_ASSERT_TRUE(log.maxGapUs < CHECK_INTERVAL_US + 2000);
+
+  RrdBucket b;
+  TEST_ASSERT_TRUE(rrdGet(RRD_RAW, 0, b));
+  TEST_ASSERT_FLOAT_WITHIN(0.5, 50.0, b.min); // the pings after the boundary are valid
+}
+
+static void checkTimeoutAcross(uint64_t boundary_us)
+{
+  simSensor(SIM_ECHO_SILENT);
+  simSetUs(boundary_us - 2500 * 1000ULL);
+  const uint32_t timeouts0 = healthStats().timeouts;
+  RunLog log = runLoop(5 * CHECK_INTERVAL_US);
+
+  // every ping ends by its timeout, the interval is kept
+  TEST_ASSERT_EQUAL_UINT32(5, log.triggers);
+  TEST_ASSERT_EQUAL_UINT32(5, healthStats().timeouts - timeouts0);
+  TEST_ASSERT_TRUE(log.minGapUs >= CHECK_INTERVAL_US);
+  TEST_ASSERT_TRUE(log.maxGapUs < CHECK_INTERVAL_US + 2000);
+}
+
+static void checkBatteryAcross(uint64_t boundary_us)
+{
+  simSensor(SIM_ECHO_OK, 50.0);
+  simSetUs(boundary_us - 5000 * 1000ULL);
+  RunLog log = runLoop(5 * BATTERY_INTERVAL_US - 1000);
+  TEST_ASSERT_EQUAL_UINT32(5, log.batteryReads); // at 0, 1993, ... 7972 ms
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_sr04_trigger_across_2e32_us(void)
+{
+  checkTriggerAcross(WRAP_US);
+}
+
+void test_sr04_timeout_across_2e32_us(void)
+{
+  checkTimeoutAcross(WRAP_US + 60 * CHECK_INTERVAL_US);
+}
+
+void test_battery_across_2e32_us(void)
+{
+  checkBatteryAcross(2 * WRAP_US);
+}
+
+void test_sr04_trigger_across_2e32_ms(void)
+{
+  checkTriggerAcross(WRAP_MS);
+}
+
+void test_sr04_timeout_across_2e32_ms(void)
+{
+  checkTimeoutAcross(WRAP_MS + 60 * CHECK_INTERVAL_US);
+}
+
+void test_battery_across_2e32_ms(void)
+{
+  checkBatteryAcross(2 * WRAP_MS);
+}
+
+void test_low_battery_power_off(void)
+{
+  // 5 consecutive low readings : checkpoint and power off
+  simBattery(3);
+  const uint32_t reads0 = simBatteryReads();
+  const uint64_t end = simNowUs() + 20 * BATTERY_INTERVAL_US;
+  while (simPowerOffs() == 0 && simNowUs() < end)
+    loop();
+  TEST_ASSERT_EQUAL_UINT32(1, simPowerOffs());
+  TEST_ASSERT_EQUAL_UINT32(5, simBatteryReads() - reads0);
+}
+
+int main(int, char **)
+{
+  simBattery(80);
+  setup();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_sr04_trigger_across_2e32_us);
+  RUN_TEST(test_sr04_timeout_across_2e32_us);
+  RUN_TEST(test_battery_across_2e32_us);
+  RUN_TEST(test_sr04_trigger_across_2e32_ms);
+  RUN_TEST(test_sr04_timeout_across_2e32_ms);
+  RUN_TEST(test_battery_across_2e32_ms);
+  RUN_TEST(test_low_battery_power_off);
+  return UNITY_END();
+}
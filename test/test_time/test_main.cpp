@@ -0,0 +1,75 @@
+// *******************************************************
+//  64-bit timebase across the 32-bit wrap points
+// -------------------------------------------------------
+//  pio test -e native -f test_time
+//  micros() wraps at 2^32 us (~71.6 min), millis() at
+//  2^32 ms (~49.7 days) : nowUs() / nowMs() and the
+//  elapsed checks must not.
+// *******************************************************
+#include <unity.h>
+#include "sim.h"
+#include "N_util.h"
+
+static constexpr uint64_t WRAP_US = 1ULL << 32;          // micros() wraps
+static constexpr uint64_t WRAP_MS = (1ULL << 32) * 1000; // millis() wraps [us]
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_now_us_across_2e32_us(void)
+{
+  simSetUs(WRAP_US - 10);
+  const uint64_t before = nowUs();
+  simAdvanceUs(20);
+  TEST_ASSERT_EQUAL_UINT64(WRAP_US - 10, before);
+  TEST_ASSERT_EQUAL_UINT64(WRAP_US + 10, nowUs());
+  TEST_ASSERT_TRUE(micros() < 100); // the 32-bit counter did wrap
+}
+
+void test_elapsed_us_across_2e32_us(void)
+{
+  simSetUs(WRAP_US + 1000000);
+  const uint64_t since = WRAP_US + 1000000 + (1ULL << 32) - 500; // next wrap - 500 us
+  simSetUs(since);
+  simAdvanceUs(999);
+  TEST_ASSERT_FALSE(elapsedUs(since, 1000));
+  simAdvanceUs(1);
+  TEST_ASSERT_TRUE(elapsedUs(since, 1000));
+  simAdvanceUs(1ULL << 32); // a full 32-bit period later
+  TEST_ASSERT_TRUE(elapsedUs(since, 1000));
+}
+
+void test_now_ms_across_2e32_ms(void)
+{
+  simSetUs(WRAP_MS - 5000);
+  const uint64_t before = nowMs();
+  simAdvanceUs(10000);
+  TEST_ASSERT_EQUAL_UINT64((1ULL << 32) - 5, before);
+  TEST_ASSERT_EQUAL_UINT64((1ULL << 32) + 5, nowMs());
+  TEST_ASSERT_TRUE(millis() < 100); // the 32-bit counter did wrap
+}
+
+void test_elapsed_ms_across_2e32_ms(void)
+{
+  const uint64_t since = nowMs() + (1ULL << 32) - 700; // next wrap - 700 ms
+  simSetUs(since * 1000);
+  simAdvanceUs(1992 * 1000ULL);
+  TEST_ASSERT_FALSE(elapsedMs(since, 1993));
+  simAdvanceUs(1000);
+  TEST_ASSERT_TRUE(elapsedMs(since, 1993));
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_now_us_across_2e32_us);
+  RUN_TEST(test_elapsed_us_across_2e32_us);
+  RUN_TEST(test_now_ms_across_2e32_ms);
+  RUN_TEST(test_elapsed_ms_across_2e32_ms);
+  return UNITY_END();
+}
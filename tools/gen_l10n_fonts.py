@@ -0,0 +1,333 @@
+# *******************************************************
+#  gen_l10n_fonts.py   font subsets for l10n.h
+# -------------------------------------------------------
+#  PlatformIO pre script (platformio.ini : extra_scripts)
+#  or standalone :
+#    python tools/gen_l10n_fonts.py [--full-fonts] [M5GFX library dir]
+#
+#  Reads the message table in src/l10n.h, cuts the M5GFX
+#  Japanese u8g2 fonts down to the ASCII / Latin-1 glyphs
+#  plus the glyphs the table uses, and precomputes the text
+#  width of every message. Writes src/l10n_fonts.gen.cpp.
+#  Skipped while l10n.h, this script and the M5GFX version
+#  are unchanged (stamp in the generated file).
+#  A font that can not be found or parsed fails the build;
+#  to build with the full fonts instead, set
+#    custom_l10n_full_fonts = yes   (platformio.ini)
+#  or pass --full-fonts when run standalone.
+# *******************************************************
+import hashlib
+import json
+import os
+import re
+import sys
+
+# (C name, M5GFX font object, u8g2 data array in M5GFX)
+FONTS = [
+    ("L10N_FONT_G12", "lgfxJapanGothic_12", "lgfx_font_japan_gothic_12"),
+    ("L10N_FONT_G16", "lgfxJapanGothic_16", "lgfx_font_japan_gothic_16"),
+    ("L10N_FONT_G24", "lgfxJapanGothic_24", "lgfx_font_japan_gothic_24"),
+    ("L10N_FONT_M16", "lgfxJapanMincho_16", "lgfx_font_japan_mincho_16"),
+]
+WIDTH_FONT = "L10N_FONT_G24"  # widths exported as L10N_WIDTH_G24
+
+U8G2_HEADER_LEN = 23
+SOURCE_EXT = (".c", ".h", ".cpp", ".hpp")
+GEN_FILE = os.path.join("src", "l10n_fonts.gen.cpp")
+
+
+class FontError(Exception):
+    pass
+
+
+def read_messages(l10n_h):
+    """[(id, [text per language])] in table order"""
+    src = open(l10n_h, encoding="utf-8").read()
+    msgs = []
+    for m in re.finditer(r'MSG\((\w+)((?:\s*,\s*"(?:[^"\\]|\\.)*")+)\)', src):
+        texts = re.findall(r'"((?:[^"\\]|\\.)*)"', m.group(2))
+        msgs.append((m.group(1), texts))
+    return msgs
+
+
+def find_font_arrays(lib_dirs, names):
+    """{name: bytes} of 'const uint8_t name[] = {...}' or a u8g2 string literal,
+    one pass over the library sources, every file read at most once"""
+    found = {}
+    pat = re.compile(r"\b(" + "|".join(map(re.escape, names)) + r")\s*\[\s*\d*\s*\][^=;]*=\s*"
+                     r'(?:\{(.*?)\};|((?:\s*"(?:[^"\\]|\\.)*")+)\s*;)', re.S)
+    for lib_dir in lib_dirs:
+        for root, _, files in os.walk(lib_dir):
+            for f in files:
+                if not f.endswith(SOURCE_EXT):
+                    continue
+                try:
+                    src = open(os.path.join(root, f), encoding="latin-1").read()
+                except OSError:
+                    continue
+                if "lgfx_font_japan" not in src:
+                    continue
+                for m in pat.finditer(src):
+                    name = m.group(1)
+                    if name in found:
+                        continue
+                    if m.group(2) is not None:
+                        body = re.sub(r"/\*.*?\*/|//[^\n]*", "", m.group(2), flags=re.S)
+                        found[name] = bytes(int(v, 0) & 0xFF for v in re.findall(r"0[xX][0-9a-fA-F]+|\d+", body))
+                    else:
+                        data = bytearray()
+                        for lit in re.findall(r'"((?:[^"\\]|\\.)*)"', m.group(3)):
+                            data += parse_c_string(lit)
+                        found[name] = bytes(data)
+                if len(found) == len(names):
+                    return found
+    return found
+
+
+def lib_version(lib_dirs):
+    """version of the M5GFX library (library.json), part of the stamp"""
+    for lib_dir in lib_dirs:
+        for root, dirs, _ in os.walk(lib_dir):
+            if os.path.basename(root) == "M5GFX" and os.path.isfile(os.path.join(root, "library.json")):
+                try:
+                    return json.load(open(os.path.join(root, "library.json"), encoding="utf-8")).get("version", "?")
+                except (OSError, ValueError):
+                    return "?"
+            if root.count(os.sep) - lib_dir.count(os.sep) >= 2:
+                dirs[:] = []  # M5GFX is at most two levels down
+    return "none"
+
+
+def make_stamp(l10n_h, lib_dirs, full_fonts):
+    h = hashlib.sha1()
+    h.update(open(l10n_h, "rb").read())
+    h.update(open(os.path.abspath(__file__), "rb").read())
+    h.update(lib_version(lib_dirs).encode())
+    h.update("\n".join(os.path.abspath(d) for d in lib_dirs).encode())
+    h.update(b"full" if full_fonts else b"subset")
+    return h.hexdigest()[:16]
+
+
+def parse_c_string(lit):
+    out = bytearray()
+    i = 0
+    while i < len(lit):
+        c = lit[i]
+        if c != "\\":
+            out += c.encode("latin-1")
+            i += 1
+            continue
+        n = lit[i + 1]
+        if n in "01234567":
+            j = i + 1
+            while j < len(lit) and j < i + 4 and lit[j] in "01234567":
+                j += 1
+            out.append(int(lit[i + 1:j], 8) & 0xFF)
+            i = j
+        elif n == "x":
+            j = i + 2
+            while j < len(lit) and lit[j] in "0123456789abcdefABCDEF":
+                j += 1
+            out.append(int(lit[i + 2:j], 16) & 0xFF)
+            i = j
+        else:
+            out += {"n": b"\n", "t": b"\t", "r": b"\r", "\\": b"\\", '"': b'"', "'": b"'"}.get(n, n.encode("latin-1"))
+            i += 2
+    return bytes(out)
+
+
+class U8g2Font:
+    """u8g2 font : 23 byte header, 8-bit glyphs, unicode jump table + glyphs"""
+
+    def __init__(self, data):
+        if len(data) < U8G2_HEADER_LEN:
+            raise ValueError("too short")
+        self.data = data
+        self.bits_w, self.bits_h, self.bits_x, self.bits_y, self.bits_dx = data[4:9]
+        self.unicode_pos = U8G2_HEADER_LEN + ((data[21] << 8) | data[22])
+        if data[21] == 0 and data[22] == 0:
+            raise ValueError("no unicode section")
+
+        self.glyphs8 = {}  # encoding -> offset of the bit stream
+        pos = U8G2_HEADER_LEN
+        while pos + 1 < self.unicode_pos and data[pos + 1] != 0:
+            self.glyphs8[data[pos]] = pos + 2
+            pos += data[pos + 1]
+
+        self.glyphs16 = {}  # encoding -> (offset of the record, size)
+        pos = self.unicode_pos + ((data[self.unicode_pos] << 8) | data[self.unicode_pos + 1])
+        while pos + 2 < len(data):
+            enc = (data[pos] << 8) | data[pos + 1]
+            size = data[pos + 2]
+            if enc == 0 or size == 0:
+                break
+            self.glyphs16[enc] = (pos, size)
+            pos += size
+
+    def _metrics(self, bit_stream):
+        """(w, x_offset, dx) of a glyph bit stream : w, h unsigned, x, y, dx signed"""
+        bitpos = 0
+
+        def bits(cnt):
+            nonlocal bitpos
+            v = 0
+            for i in range(cnt):
+                byte = self.data[bit_stream + (bitpos + i) // 8]
+                v |= ((byte >> ((bitpos + i) % 8)) & 1) << i
+            bitpos += cnt
+            return v
+
+        def signed(cnt):
+            return bits(cnt) - (1 << (cnt - 1))
+
+        w = bits(self.bits_w)
+        bits(self.bits_h)
+        x = signed(self.bits_x)
+        signed(self.bits_y)
+        return w, x, signed(self.bits_dx)
+
+    def metrics(self, cp):
+        if cp < 0x100 and cp in self.glyphs8:
+            return self._metrics(self.glyphs8[cp])
+        if cp in self.glyphs16:
+            return self._metrics(self.glyphs16[cp][0] + 3)
+        return None
+
+    def advance(self, cp):
+        m = self.metrics(cp)
+        return None if m is None else m[2]
+
+    def text_width(self, text):
+        """as LovyanGFX textWidth() : a negative x offset of the first glyph
+        widens the left side, the last glyph counts with its ink width"""
+        left = right = 0
+        for ch in text:
+            m = self.metrics(ord(ch))
+            if m is None:
+                return -1
+            w, x, dx = m
+            if left == 0 and right == 0 and x < 0:
+                left = right = -x
+            right = left + max(dx, w + x)
+            left += dx
+        return right
+
+    def subset(self, codepoints):
+        """8-bit section as is, unicode section with the given glyphs only"""
+        keep = sorted(cp for cp in codepoints if cp in self.glyphs16)
+        out = bytearray(self.data[:self.unicode_pos])
+        out[0] = min(len(self.glyphs8) + len(keep), 0xFF)  # glyph count (informative)
+        out += bytes([0x00, 0x04, 0xFF, 0xFF])  # one jump table entry : glyphs follow
+        for cp in keep:
+            pos, size = self.glyphs16[cp]
+            out += self.data[pos:pos + size]
+        out += bytes([0x00, 0x00])
+        return bytes(out)
+
+
+def generate(project_dir, lib_dirs, full_fonts=False):
+    """writes GEN_FILE, FontError if a font can not be subset (unless full_fonts)"""
+    l10n_h = os.path.join(project_dir, "src", "l10n.h")
+    path = os.path.join(project_dir, GEN_FILE)
+    stamp = make_stamp(l10n_h, lib_dirs, full_fonts)
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.readline().strip() == "// stamp: " + stamp:
+                return  # l10n.h, this script and M5GFX unchanged
+
+    msgs = read_messages(l10n_h)
+    n_lang = max(len(t) for _, t in msgs)
+    used = set()
+    for _, texts in msgs:
+        for text in texts:
+            used.update(ord(ch) for ch in text if ord(ch) >= 0x80)
+
+    out = [
+        "// stamp: " + stamp,
+        "// generated by tools/gen_l10n_fonts.py from l10n.h : do not edit",
+        '#include "l10n_fonts.h"',
+        "",
+        "static_assert(MSG_NUM == %d && LANG_NUM == %d, \"l10n.h changed : rebuild to regenerate\");" % (len(msgs), n_lang),
+        "",
+    ]
+    widths = None
+    report = []
+    total_full = total_sub = 0
+    arrays = find_font_arrays(lib_dirs, [a for _, _, a in FONTS])
+    for c_name, full_name, array_name in FONTS:
+        font = None
+        data = arrays.get(array_name)
+        try:
+            if data is None:
+                raise ValueError("source of %s not found in %s" % (array_name, ", ".join(lib_dirs)))
+            font = U8g2Font(data)
+            missing = [cp for cp in used if font.advance(cp) is None]
+            if missing:
+                raise ValueError("glyphs missing : " + "".join(chr(cp) for cp in missing))
+        except (ValueError, IndexError) as e:
+            if not full_fonts:
+                raise FontError("%s : %s" % (full_name, e))
+            report.append("WARNING %s : %s, using the full font" % (full_name, e))
+            font = None
+
+        if font is None:
+            out.append("const lgfx::IFont *const %s = &fonts::%s;" % (c_name, full_name))
+            out.append("")
+            continue
+
+        sub = font.subset(used)
+        total_full += len(data)
+        total_sub += len(sub)
+        report.append("%s : %d -> %d bytes" % (full_name, len(data), len(sub)))
+        var = "l10n_" + array_name
+        out.append("static const uint8_t %s[] = {" % var)
+        for i in range(0, len(sub), 16):
+            out.append("    " + ", ".join("0x%02x" % b for b in sub[i:i + 16]) + ",")
+        out.append("};")
+        out.append("static const lgfx::U8g2font %s_font = {%s};" % (var, var))
+        out.append("const lgfx::IFont *const %s = &%s_font;" % (c_name, var))
+        out.append("")
+        if c_name == WIDTH_FONT:
+            sub_font = U8g2Font(sub)
+            widths = [[sub_font.text_width(texts[lang]) for _, texts in msgs] for lang in range(n_lang)]
+
+    if widths is None:
+        widths = [[-1] * len(msgs) for _ in range(n_lang)]
+    out.append("const int16_t L10N_WIDTH_G24[LANG_NUM][MSG_NUM] = {")
+    for row in widths:
+        out.append("    {" + ", ".join(str(w) for w in row) + "},")
+    out.append("};")
+
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(out) + "\n")
+    report.append("font data %d -> %d bytes (M5GFX %s)" % (total_full, total_sub, lib_version(lib_dirs)))
+    for line in report:
+        print("l10n: " + line)
+
+
+def lib_dirs_for_env(env):
+    libdeps = env.subst("$PROJECT_LIBDEPS_DIR/$PIOENV")
+    return [os.path.join(libdeps, d) for d in ("M5GFX", "M5Unified", "M5Cardputer") if os.path.isdir(os.path.join(libdeps, d))] or [libdeps]
+
+
+try:
+    Import  # noqa: F821 (defined when run by PlatformIO)
+except NameError:
+    Import = None
+
+if Import is not None:
+    Import("env")
+    try:
+        generate(env.subst("$PROJECT_DIR"), lib_dirs_for_env(env),  # noqa: F821
+                 env.GetProjectOption("custom_l10n_full_fonts", "no").lower() in ("yes", "true", "1"))  # noqa: F821
+    except FontError as e:
+        print("l10n: error : %s" % e)
+        print("l10n: set custom_l10n_full_fonts = yes in platformio.ini to build with the full fonts")
+        env.Exit(1)  # noqa: F821
+elif __name__ == "__main__":
+    here = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    args = [a for a in sys.argv[1:] if a != "--full-fonts"]
+    try:
+        generate(here, args or [os.path.join(here, ".pio", "libdeps")], "--full-fonts" in sys.argv[1:])
+    except FontError as e:
+        sys.exit("l10n: error : %s (pass --full-fonts to use the full fonts)" % e)